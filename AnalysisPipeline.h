@@ -0,0 +1,122 @@
+#ifndef ANALYSISPIPELINE_H
+#define ANALYSISPIPELINE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Hands samples from the simulation thread to a worker thread, which analyzes
+// them and writes the output while the next ticks are simulated. The queue is
+// bounded: when the worker falls behind, acquire() returns nullptr and the
+// sample is dropped, the simulation never waits for the analysis. The worker
+// is started with the first sample, worlds that are never analyzed do not
+// get a thread.
+template <class T>
+class AnalysisPipeline
+{
+public:
+	using Analyze = std::function<void(T& sample)>;
+
+	explicit AnalysisPipeline(Analyze analyze, std::size_t capacity = 2)
+		: analyze(analyze)
+		, slots(capacity)
+		, head(0)
+		, tail(0)
+		, dropped(0)
+		, stopping(false)
+	{
+	}
+
+	AnalysisPipeline(const AnalysisPipeline& other) = delete;
+
+	AnalysisPipeline& operator=(const AnalysisPipeline& other) = delete;
+
+	~AnalysisPipeline()
+	{
+		finish();
+	}
+
+	// producer
+
+	// a free slot to fill and submit(), nullptr when the sample is dropped
+	T* acquire()
+	{
+		std::uint64_t index = head.load(std::memory_order_relaxed);
+		if ((index - tail.load(std::memory_order_acquire)) >= slots.size()) {
+			dropped += 1;
+			return nullptr;
+		}
+		if (!worker.joinable()) {
+			worker = std::thread(&AnalysisPipeline::work, this);
+		}
+		return &slots[index % slots.size()];
+	}
+
+	void submit()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+		}
+		condition.notify_one();
+	}
+
+	std::uint64_t droppedCount() const
+	{
+		return dropped;
+	}
+
+	// analyzes the samples still queued and stops the worker, a later sample
+	// starts it again
+	void finish()
+	{
+		if (worker.joinable()) {
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				stopping = true;
+			}
+			condition.notify_one();
+			worker.join();
+			stopping = false;
+		}
+	}
+
+private:
+	void work()
+	{
+		std::uint64_t index = tail.load(std::memory_order_relaxed);
+		while (true) {
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				condition.wait(lock, [&] {
+					return stopping || index != head.load(std::memory_order_acquire);
+				});
+				if (index == head.load(std::memory_order_acquire)) {
+					return;
+				}
+			}
+			analyze(slots[index % slots.size()]);
+			index += 1;
+			tail.store(index, std::memory_order_release);
+		}
+	}
+
+	Analyze analyze;
+
+	std::vector<T> slots;
+	// submitted and analyzed samples
+	std::atomic<std::uint64_t> head;
+	std::atomic<std::uint64_t> tail;
+	std::uint64_t dropped;
+
+	std::mutex mutex;
+	std::condition_variable condition;
+	bool stopping;
+	std::thread worker;
+};
+
+#endif // ANALYSISPIPELINE_H
@@ -1,9 +1,21 @@
 #include "Application.h"
 
+#include "PhaseTrace.h"
+#include "Texture.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <iostream>
 
-Application::Application()
-	: running(false)
+Application::Application(std::unique_ptr<Simulation> world, const TickScheduler& scheduler)
+	: world(std::move(world))
+	, running(false)
+	, reportedFrameCounter(0)
+	, reportedUploadedByteCount(0)
+	, scheduler(scheduler)
+	, tickHistogram("ticks")
+	, frameHistogram("frames")
 {
 }
 
@@ -13,30 +25,37 @@ void Application::run()
 		return;
 	}
 
-	Uint64 frameTime = SDL_GetPerformanceFrequency() / 1;
-	Uint64 time = SDL_GetPerformanceCounter();
+	typedef std::chrono::steady_clock Clock;
+	const Clock::duration reportPeriod = std::chrono::seconds(1);
 
 	// Display first frame
+	world->snapshot();
 	render();
 
+	simulationThread = std::thread(&Application::simulate, this);
+
+	Clock::time_point reportTime = Clock::now();
+	Clock::time_point frameTime = reportTime;
 	while (running) {
+		scheduler.waitForFrame();
+
+		Clock::time_point now = Clock::now();
+		frameHistogram.record(now - frameTime);
+		frameTime = now;
 		frameCounter += 1;
 
 		handleEvents();
 
-		int u = 1;
-		update();
-		while ((SDL_GetPerformanceCounter() - time) < frameTime) {
-			++u;
-			update();
-		}
-
-		time = SDL_GetPerformanceCounter();
-
-		std::cout << "updates: " << u << std::endl;
 		render();
+
+		if ((now - reportTime) >= reportPeriod) {
+			report(std::chrono::duration<double>(now - reportTime).count());
+			reportTime = now;
+		}
 	}
 
+	simulationThread.join();
+
 	cleanup();
 }
 
@@ -81,34 +100,126 @@ bool Application::initialize()
 
 	//glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
 
-	return world.initialize();
+	if (!world->initialize()) {
+		return false;
+	}
+
+	// NOTE: the world covers 0.955 of the window in both directions
+	int width, height;
+	SDL_GL_GetDrawableSize(window, &width, &height);
+	viewport.width = int(width * 0.955f);
+	viewport.height = int(height * 0.955f);
+	world->setViewport(viewport);
+
+	return true;
 }
 
+// The wheel zooms, dragging with the left button and the arrow keys pan and
+// home shows the whole world again.
 void Application::handleEvents()
 {
+	Viewport previousViewport = viewport;
 	SDL_Event event;
 	while (SDL_PollEvent(&event)) {
 		if (event.type == SDL_QUIT) {
 			running = false;
+		} else if (event.type == SDL_MOUSEWHEEL) {
+			viewport.zoomBy(std::pow(1.25f, float(event.wheel.y)));
+		} else if (event.type == SDL_MOUSEMOTION && (event.motion.state & SDL_BUTTON_LMASK)) {
+			// NOTE: column 0 is on the right and row 0 on the top
+			viewport.pan(float(event.motion.xrel) / viewport.width, -float(event.motion.yrel) / viewport.height);
+		} else if (event.type == SDL_KEYDOWN) {
+			switch (event.key.keysym.sym) {
+			case SDLK_LEFT:
+				viewport.pan(0.1f, 0.0f);
+				break;
+			case SDLK_RIGHT:
+				viewport.pan(-0.1f, 0.0f);
+				break;
+			case SDLK_UP:
+				viewport.pan(0.0f, -0.1f);
+				break;
+			case SDLK_DOWN:
+				viewport.pan(0.0f, 0.1f);
+				break;
+			case SDLK_HOME:
+				viewport.centerX = 0.5f;
+				viewport.centerY = 0.5f;
+				viewport.zoom = 1.0f;
+				break;
+			default:
+				break;
+			}
+		}
+	}
+
+	if (viewport.centerX != previousViewport.centerX
+			|| viewport.centerY != previousViewport.centerY
+			|| viewport.zoom != previousViewport.zoom) {
+		world->setViewport(viewport);
+	}
+}
+
+// Runs on its own thread, render() only ever sees the published snapshots,
+// so the update rate does not depend on the frame rate. The world is
+// analyzed once a second, like the report, however fast it ticks.
+void Application::simulate()
+{
+	typedef std::chrono::steady_clock Clock;
+	const Clock::duration analysisPeriod = std::chrono::seconds(1);
+
+	Clock::time_point analysisTime = Clock::now() - analysisPeriod;
+	while (running) {
+		scheduler.waitForTick();
+
+		Clock::time_point start = Clock::now();
+		update();
+		Clock::time_point now = Clock::now();
+		tickHistogram.record(now - start);
+
+		if ((now - analysisTime) >= analysisPeriod) {
+			world->analyze();
+			analysisTime = now;
 		}
+		world->snapshot();
 	}
 }
 
 void Application::update()
 {
 	updateCounter += 1;
-	world.update();
+	world->update();
 }
 
 void Application::render()
 {
 	glClear(GL_COLOR_BUFFER_BIT);
 
-	world.render();
+	{
+		// NOTE: only the submission, the GPU draws asynchronously
+		PHASE_SCOPE("render");
+		world->render();
+	}
 
+	PHASE_SCOPE("swap");
 	SDL_GL_SwapWindow(window);
 }
 
+// Ticks are timed by the duration of update(), frames by the interval
+// between them.
+void Application::report(double seconds)
+{
+	tickHistogram.report(std::cout, seconds);
+	frameHistogram.report(std::cout, seconds);
+	PhaseTrace::report(std::cout, seconds);
+
+	int frames = std::max(frameCounter - reportedFrameCounter, 1);
+	std::size_t uploadedBytes = Texture::uploadedByteCount() - reportedUploadedByteCount;
+	std::cout << "uploaded bytes/frame: " << uploadedBytes / frames << std::endl;
+	reportedFrameCounter = frameCounter;
+	reportedUploadedByteCount = Texture::uploadedByteCount();
+}
+
 void Application::cleanup()
 {
 	SDL_GL_DeleteContext(glContext);
@@ -1,16 +1,23 @@
 #ifndef APPLICATION_H
 #define APPLICATION_H
 
-#include "GameOfLife/GameOfLifeWorld.h"
-#include "GridWorld/GridWorld.h"
-#include "PlantWorld/PlantWorld.h"
+#include "Simulation.h"
+#include "TickScheduler.h"
+#include "TimingHistogram.h"
+#include "Viewport.h"
 
+#include <GL/glew.h>
 #include <SDL2/SDL.h>
 
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <thread>
+
 class Application
 {
 public:
-	Application();
+	Application(std::unique_ptr<Simulation> world, const TickScheduler& scheduler);
 
 	void run();
 
@@ -19,20 +26,32 @@ private:
 
 	void handleEvents();
 
+	void simulate();
+
 	void update();
 
 	void render();
 
+	void report(double seconds);
+
 	void cleanup();
 
 private:
-	GridWorld world;
-	//GameOfLife::GameOfLifeWorld world;
-	//PlantWorld::PlantWorld world;
+	std::unique_ptr<Simulation> world;
 
-	bool running;
+	std::atomic<bool> running;
 	int frameCounter;
-	int updateCounter;
+	int reportedFrameCounter;
+	std::size_t reportedUploadedByteCount;
+	std::atomic<int> updateCounter;
+
+	std::thread simulationThread;
+
+	Viewport viewport;
+
+	TickScheduler scheduler;
+	TimingHistogram tickHistogram;
+	TimingHistogram frameHistogram;
 
 	SDL_Window *window;
 	SDL_GLContext glContext;
@@ -0,0 +1,60 @@
+#include "Arena.h"
+
+#include <algorithm>
+#include <cstdint>
+
+thread_local Arena* Arena::currentArena = nullptr;
+
+Arena::Scope::Scope(Arena& arena)
+	: previous(currentArena)
+{
+	currentArena = &arena;
+}
+
+Arena::Scope::~Scope()
+{
+	currentArena = previous;
+}
+
+Arena::Arena(std::size_t chunkSize)
+	: chunkSize(chunkSize)
+	, chunkIndex(0)
+	, used(0)
+{
+}
+
+void* Arena::allocate(std::size_t size, std::size_t alignment)
+{
+	while (chunkIndex < chunks.size()) {
+		Chunk& chunk = chunks[chunkIndex];
+		std::uintptr_t base = reinterpret_cast<std::uintptr_t>(chunk.data.get());
+		std::size_t offset = ((base + used + alignment - 1) & ~std::uintptr_t(alignment - 1)) - base;
+		if (offset + size <= chunk.size) {
+			used = offset + size;
+			return chunk.data.get() + offset;
+		}
+		chunkIndex += 1;
+		used = 0;
+	}
+
+	std::size_t newChunkSize = std::max(chunkSize, size + alignment);
+	chunks.push_back({std::unique_ptr<char[]>(new char[newChunkSize]), newChunkSize});
+	chunkIndex = chunks.size() - 1;
+	used = 0;
+	return allocate(size, alignment);
+}
+
+void Arena::reset()
+{
+	chunkIndex = 0;
+	used = 0;
+}
+
+std::size_t Arena::capacity() const
+{
+	std::size_t result = 0;
+	for (const Chunk& chunk : chunks) {
+		result += chunk.size;
+	}
+	return result;
+}
@@ -0,0 +1,67 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Bump allocator owned by a single thread. Memory is only given back by
+// reset(), which keeps the chunks for the next user. While a Scope is alive
+// Block allocates its cells from the thread's current arena.
+class Arena
+{
+public:
+	class Scope
+	{
+	public:
+		explicit Scope(Arena& arena);
+
+		Scope(const Scope& other) = delete;
+
+		Scope& operator=(const Scope& other) = delete;
+
+		~Scope();
+
+	private:
+		Arena* previous;
+	};
+
+	explicit Arena(std::size_t chunkSize = 1 << 20);
+
+	Arena(const Arena& other) = delete;
+
+	Arena& operator=(const Arena& other) = delete;
+
+	void* allocate(std::size_t size, std::size_t alignment);
+
+	template <class T>
+	T* allocate(std::size_t count)
+	{
+		return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+	}
+
+	void reset();
+
+	std::size_t capacity() const;
+
+	static Arena* current()
+	{
+		return currentArena;
+	}
+
+private:
+	struct Chunk
+	{
+		std::unique_ptr<char[]> data;
+		std::size_t size;
+	};
+
+	std::size_t chunkSize;
+	std::vector<Chunk> chunks;
+	std::size_t chunkIndex;
+	std::size_t used;
+
+	static thread_local Arena* currentArena;
+};
+
+#endif // ARENA_H
@@ -0,0 +1,161 @@
+#include "BenchmarkRunner.h"
+
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+double timeBatch(const BenchmarkRunner::Case& benchmark, std::uint64_t operationCount)
+{
+	auto start = Clock::now();
+	benchmark.run(operationCount);
+	return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// NOTE: names are plain identifiers, nothing needs escaping
+template <class T>
+void writeField(std::ostream& out, const char* name, T value)
+{
+	out << ", \"" << name << "\": " << value;
+}
+
+} // namespace
+
+BenchmarkRunner::BenchmarkRunner(double minSeconds, const std::string& filter)
+	: minSeconds(minSeconds)
+	, filter(filter)
+{
+}
+
+bool BenchmarkRunner::selected(const std::string& name) const
+{
+	return name.find(filter) != std::string::npos;
+}
+
+void BenchmarkRunner::run(const Case& benchmark)
+{
+	double organismSum = 0;
+	int organismSampleCount = 0;
+	auto sampleOrganisms = [&]() {
+		if (benchmark.organisms) {
+			organismSum += benchmark.organisms();
+			organismSampleCount += 1;
+		}
+	};
+
+	Result result = {benchmark, 0, 0, 0, 0, {}, false};
+	double best = 0;
+	std::uint64_t batch = 1;
+	if (benchmark.operationCount > 0) {
+		sampleOrganisms();
+		result.operationCount = benchmark.operationCount;
+		result.seconds = timeBatch(benchmark, benchmark.operationCount);
+		best = result.seconds / benchmark.operationCount;
+		sampleOrganisms();
+	} else {
+		while (true) {
+			sampleOrganisms();
+			double seconds = timeBatch(benchmark, batch);
+			result.operationCount += batch;
+			result.seconds += seconds;
+			best = seconds / batch;
+			if (seconds >= minSeconds / 10) {
+				break;
+			}
+			batch *= 2;
+		}
+		while (result.seconds < minSeconds) {
+			sampleOrganisms();
+			double seconds = timeBatch(benchmark, batch);
+			result.operationCount += batch;
+			result.seconds += seconds;
+			best = std::min(best, seconds / batch);
+		}
+	}
+
+	result.nsPerOperation = best * 1e9;
+	result.organisms = organismSampleCount > 0 ? organismSum / organismSampleCount : 0;
+	if (benchmark.values) {
+		result.values = benchmark.values();
+	}
+	results.push_back(result);
+
+	std::cerr << benchmark.name;
+	if (benchmark.size > 0) {
+		std::cerr << " " << benchmark.size << "x" << benchmark.size;
+	}
+	if (benchmark.occupancy >= 0) {
+		std::cerr << " occupancy " << benchmark.occupancy;
+	}
+	std::cerr << ": " << result.nsPerOperation << " ns" << std::endl;
+}
+
+void BenchmarkRunner::skip(const Case& benchmark)
+{
+	Result result = {benchmark, 0, 0, 0, 0, {}, true};
+	results.push_back(result);
+}
+
+void BenchmarkRunner::writeJson(std::ostream& out) const
+{
+	std::time_t now = std::time(nullptr);
+	char date[32];
+	std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+#ifdef _OPENMP
+	int threadCount = omp_get_max_threads();
+#else
+	int threadCount = 1;
+#endif
+
+	out << std::setprecision(6);
+	out << "{\n";
+	out << "  \"date\": \"" << date << "\",\n";
+	out << "  \"compiler\": \"" << __VERSION__ << "\",\n";
+	out << "  \"hardwareConcurrency\": " << std::thread::hardware_concurrency() << ",\n";
+	out << "  \"threads\": " << threadCount << ",\n";
+	out << "  \"minSeconds\": " << minSeconds << ",\n";
+	out << "  \"results\": [";
+	for (std::size_t i = 0; i < results.size(); ++i) {
+		const Result& result = results[i];
+		const Case& benchmark = result.benchmark;
+		out << (i > 0 ? "," : "") << "\n    {\"name\": \"" << benchmark.name << "\"";
+		if (benchmark.size > 0) {
+			writeField(out, "size", benchmark.size);
+		}
+		if (benchmark.occupancy >= 0) {
+			writeField(out, "occupancy", benchmark.occupancy);
+		}
+		if (result.skipped) {
+			writeField(out, "skipped", "true");
+			out << "}";
+			continue;
+		}
+		writeField(out, "operations", result.operationCount);
+		writeField(out, "seconds", result.seconds);
+		writeField(out, "nsPerOperation", result.nsPerOperation);
+		if (benchmark.cellsPerOperation > 0) {
+			writeField(out, "cellsPerSecond", benchmark.cellsPerOperation * 1e9 / result.nsPerOperation);
+		}
+		if (benchmark.organisms) {
+			writeField(out, "organisms", result.organisms);
+			if (result.organisms > 0) {
+				writeField(out, "nsPerOrganism", result.nsPerOperation / result.organisms);
+			}
+		}
+		for (const std::pair<std::string, double>& value : result.values) {
+			writeField(out, value.first.c_str(), value.second);
+		}
+		out << "}";
+	}
+	out << "\n  ]\n";
+	out << "}\n";
+}
@@ -0,0 +1,70 @@
+#ifndef BENCHMARKRUNNER_H
+#define BENCHMARKRUNNER_H
+
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Times benchmark cases and writes their results as JSON. A case runs
+// batches of operations: the batch doubles until it takes a tenth of the
+// minimum time, then batches run until the minimum time is spent and the
+// fastest one is kept, which is the least disturbed by other processes.
+// Cases with an operation count run it once, its mean is kept.
+class BenchmarkRunner
+{
+public:
+	struct Case
+	{
+		std::string name;
+		int size = 0; // rows and columns, 0 for cases without a grid
+		double occupancy = -1; // initial organisms per cell, negative for cases without organisms
+		double cellsPerOperation = 0; // 0 where cells are not what is measured
+
+		// runs exactly this many operations in a single batch instead, for
+		// cases whose operations change what the next ones do
+		std::uint64_t operationCount = 0;
+
+		// performs the given number of operations
+		std::function<void(std::uint64_t)> run;
+
+		// organisms an operation goes over, sampled between the batches and
+		// left out of the timing
+		std::function<double()> organisms;
+
+		// further values of the result by name, read once after the timing
+		std::function<std::vector<std::pair<std::string, double>>()> values;
+	};
+
+	struct Result
+	{
+		Case benchmark;
+		std::uint64_t operationCount;
+		double seconds;
+		double nsPerOperation;
+		double organisms;
+		std::vector<std::pair<std::string, double>> values;
+		bool skipped;
+	};
+
+	BenchmarkRunner(double minSeconds, const std::string& filter);
+
+	// cases whose name contains the filter
+	bool selected(const std::string& name) const;
+
+	void run(const Case& benchmark);
+
+	// lists the case in the results without running it
+	void skip(const Case& benchmark);
+
+	void writeJson(std::ostream& out) const;
+
+private:
+	double minSeconds;
+	std::string filter;
+	std::vector<Result> results;
+};
+
+#endif // BENCHMARKRUNNER_H
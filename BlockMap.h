@@ -1,10 +1,12 @@
 #ifndef BLOCKMAP_H
 #define BLOCKMAP_H
 
+#include "Arena.h"
 #include "Position.h"
 
 #include <cassert>
 #include <cmath>
+#include <new>
 #include <vector>
 #include <iostream>
 
@@ -13,9 +15,10 @@ class Block
 {
 public:
 	Block(int rows, int columns)
-		: mPlantCells(new CellType[rows*columns])
+		: mPlantCells(allocateCells(rows*columns))
 		, mRows(rows)
 		, mColumns(columns)
+		, mArenaAllocated(Arena::current() != nullptr)
 	{
 		//std::cout << mRows << "x" << mColumns << std::endl;
 	}
@@ -26,6 +29,7 @@ public:
 		: mPlantCells(other.mPlantCells)
 		, mRows(other.mRows)
 		, mColumns(other.mColumns)
+		, mArenaAllocated(other.mArenaAllocated)
 	{
 		other.mPlantCells = nullptr;
 	}
@@ -34,15 +38,18 @@ public:
 
 	Block& operator=(Block&& other)
 	{
+		freeCells();
 		mPlantCells = other.mPlantCells;
 		mRows = other.mRows;
 		mColumns = other.mColumns;
+		mArenaAllocated = other.mArenaAllocated;
 		other.mPlantCells = nullptr;
+		return *this;
 	}
 
 	~Block()
 	{
-		delete[] mPlantCells;
+		freeCells();
 	}
 
 	CellType& cell(int row, int col)
@@ -78,12 +85,38 @@ public:
 	}
 
 private:
+	static CellType* allocateCells(int count)
+	{
+		Arena* arena = Arena::current();
+		if (!arena) {
+			return new CellType[count];
+		}
+		CellType* cells = arena->allocate<CellType>(count);
+		for (int i = 0; i < count; ++i) {
+			new (cells + i) CellType();
+		}
+		return cells;
+	}
+
+	// NOTE: arena memory is given back by Arena::reset()
+	void freeCells()
+	{
+		if (!mArenaAllocated) {
+			delete[] mPlantCells;
+		} else if (mPlantCells) {
+			for (int i = 0; i < mRows*mColumns; ++i) {
+				mPlantCells[i].~CellType();
+			}
+		}
+	}
+
 	CellType* mPlantCells;
 	int mRows;
 	int mColumns;
+	bool mArenaAllocated;
 };
 
-template <class CellType, int BLOCK_ROWS, int BLOCK_COLUMNS>
+template <class CellType, int BLOCK_ROWS, int BLOCK_COLUMNS, class BlockType = Block<CellType>>
 class BlockMap
 {
 public:
@@ -106,7 +139,7 @@ public:
 				} else {
 					blockColumns = columns - j*BLOCK_COLUMNS;
 				}
-				blocks[i].push_back(Block<CellType>(blockRows, blockColumns));
+				blocks[i].push_back(BlockType(blockRows, blockColumns));
 			}
 		}
 	}
@@ -149,30 +182,55 @@ public:
 		return mColumns;
 	}
 
-	Block<CellType>& block(int row, int col)
+	BlockType& block(int row, int col)
 	{
 		assert(row < mRows && col < mColumns);
 		return blocks[row][col];
 	}
 
-	const Block<CellType>& block(int row, int col) const
+	const BlockType& block(int row, int col) const
 	{
 		assert(row < mRows && col < mColumns);
 		return blocks[row][col];
 	}
 
-	Block<CellType>& block(Position p)
+	BlockType& block(Position p)
 	{
 		return block(p.row, p.col);
 	}
 
-	const Block<CellType>& block(Position p) const
+	const BlockType& block(Position p) const
 	{
 		return block(p.row, p.col);
 	}
 
+	BlockType& blockAt(int row, int col)
+	{
+		return blocks[row / BLOCK_ROWS][col / BLOCK_COLUMNS];
+	}
+
+	const BlockType& blockAt(int row, int col) const
+	{
+		return blocks[row / BLOCK_ROWS][col / BLOCK_COLUMNS];
+	}
+
+	BlockType& blockAt(Position p)
+	{
+		return blockAt(p.row, p.col);
+	}
+
+	const BlockType& blockAt(Position p) const
+	{
+		return blockAt(p.row, p.col);
+	}
+
+	static Position localPosition(Position p)
+	{
+		return Position(p.row % BLOCK_ROWS, p.col % BLOCK_COLUMNS);
+	}
+
 private:
-	std::vector<std::vector<Block<CellType>>> blocks;
+	std::vector<std::vector<BlockType>> blocks;
 	int width;
 	int height;
 	int mRows;
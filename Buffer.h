@@ -3,6 +3,9 @@
 
 #include <GL/glew.h>
 
+#include <algorithm>
+#include <array>
+#include <cstddef>
 #include <vector>
 
 class GlBuffer
@@ -89,6 +92,150 @@ public:
 	}
 };
 
+// Vertex buffer for data rewritten every frame, written in place instead of
+// through glBufferData. The storage is split into REGION_COUNT regions used
+// round-robin, a fence after the draw keeps the next writes of a region
+// waiting until the GPU is done reading it. With ARB_buffer_storage the
+// buffer stays persistently and coherently mapped, otherwise each region is
+// mapped unsynchronized while it is written. The storage only grows, by
+// doubling, a new buffer object needs the attribute pointers set again.
+template <class T>
+class StreamingVertexBuffer : public GlBuffer
+{
+public:
+	static constexpr int REGION_COUNT = 3;
+
+	StreamingVertexBuffer()
+		: capacity(0)
+		, region(0)
+		, size(0)
+		, persistent(false)
+		, mapping(nullptr)
+		, mapped(false)
+	{
+		fences.fill(nullptr);
+	}
+
+	StreamingVertexBuffer(const StreamingVertexBuffer& other) = delete;
+
+	StreamingVertexBuffer& operator=(const StreamingVertexBuffer& other) = delete;
+
+	~StreamingVertexBuffer()
+	{
+		release();
+	}
+
+	void bind() const
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, index);
+	}
+
+	// room for count elements in the next region, valid until unmap()
+	T* map(std::size_t count)
+	{
+		region = (region + 1) % REGION_COUNT;
+		if (count > capacity) {
+			reserve(std::max(count, std::max<std::size_t>(capacity * 2, 1024)));
+		}
+		waitFence(region);
+		size = count;
+		if (persistent) {
+			return mapping + region * capacity;
+		}
+		if (count == 0) {
+			return nullptr;
+		}
+		bind();
+		mapped = true;
+		return static_cast<T*>(glMapBufferRange(GL_ARRAY_BUFFER, offset(), count * sizeof(T),
+			GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT));
+	}
+
+	void unmap()
+	{
+		if (mapped) {
+			bind();
+			glUnmapBuffer(GL_ARRAY_BUFFER);
+			mapped = false;
+		}
+	}
+
+	// after every draw reading the current region
+	void fence()
+	{
+		if (fences[region]) {
+			glDeleteSync(fences[region]);
+		}
+		fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	}
+
+	// byte offset of the current region
+	GLintptr offset() const
+	{
+		return region * capacity * sizeof(T);
+	}
+
+	// elements written to the current region
+	std::size_t count() const
+	{
+		return size;
+	}
+
+private:
+	static constexpr GLbitfield PERSISTENT_FLAGS = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+	void waitFence(int i)
+	{
+		if (fences[i]) {
+			while (glClientWaitSync(fences[i], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED) {
+			}
+			glDeleteSync(fences[i]);
+			fences[i] = nullptr;
+		}
+	}
+
+	void release()
+	{
+		for (int i = 0; i < REGION_COUNT; ++i) {
+			waitFence(i);
+		}
+		if (mapping) {
+			bind();
+			glUnmapBuffer(GL_ARRAY_BUFFER);
+			mapping = nullptr;
+		}
+		glDeleteBuffers(1, &index);
+		index = 0;
+	}
+
+	void reserve(std::size_t newCapacity)
+	{
+		release();
+		glGenBuffers(1, &index);
+		capacity = newCapacity;
+		bind();
+		GLsizeiptr bytes = REGION_COUNT * capacity * sizeof(T);
+		persistent = GLEW_ARB_buffer_storage;
+		if (persistent) {
+			glBufferStorage(GL_ARRAY_BUFFER, bytes, nullptr, PERSISTENT_FLAGS);
+			mapping = static_cast<T*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, bytes, PERSISTENT_FLAGS));
+			// NOTE: storage with the write bit can still be mapped per region
+			persistent = mapping != nullptr;
+		} else {
+			glBufferData(GL_ARRAY_BUFFER, bytes, nullptr, GL_STREAM_DRAW);
+		}
+	}
+
+	std::size_t capacity;
+	int region;
+	std::size_t size;
+	std::array<GLsync, REGION_COUNT> fences;
+
+	bool persistent;
+	T* mapping;
+	bool mapped;
+};
+
 class ElementArrayBuffer : public GlBuffer
 {
 public:
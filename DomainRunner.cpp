@@ -0,0 +1,234 @@
+#include "DomainRunner.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <type_traits>
+
+// NOTE: rows are sent as raw cells, which needs CELL_ORGANISM_USE_PTR 0
+static_assert(std::is_trivially_copyable<Cell>::value, "cells are copied byte by byte");
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+int firstBlockRowOf(int rows, int domainCount, int domain)
+{
+	return domain * GridWorld::blockRowCount(rows) / domainCount;
+}
+
+template <class T>
+void append(std::vector<char>& buffer, const T& value)
+{
+	const char* bytes = reinterpret_cast<const char*>(&value);
+	buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+}
+
+template <class T>
+T extract(const char*& bytes)
+{
+	T value;
+	std::memcpy(&value, bytes, sizeof(T));
+	bytes += sizeof(T);
+	return value;
+}
+
+} // namespace
+
+bool DomainRunner::partition(int rows, int domainCount, int domain, int& firstBlockRow, int& blockRowCount)
+{
+	firstBlockRow = firstBlockRowOf(rows, domainCount, domain);
+	blockRowCount = firstBlockRowOf(rows, domainCount, domain + 1) - firstBlockRow;
+	if (domainCount == 1) {
+		return true;
+	}
+	// halo rows must not be owned rows of the same domain
+	int firstRow = firstBlockRow * GridWorld::blockRowHeight();
+	int lastRow = std::min(rows, (firstBlockRow + blockRowCount) * GridWorld::blockRowHeight());
+	return blockRowCount > 0 && (lastRow - firstRow) >= 2;
+}
+
+DomainRunner::DomainRunner(const Settings& settings, int domain, int domainCount, Transport& transport)
+	: tickCount(settings.tickCount)
+	, domain(domain)
+	, domainCount(domainCount)
+	, transport(transport)
+	, world(settings.rows, settings.columns, settings.population,
+		firstBlockRowOf(settings.rows, domainCount, domain),
+		firstBlockRowOf(settings.rows, domainCount, domain + 1) - firstBlockRowOf(settings.rows, domainCount, domain))
+	, randomState(0)
+	, stamps(settings.rows, -1)
+	, rowCells(settings.columns)
+	, bytesSent(0)
+	, communicationSeconds(0)
+{
+	world.setSeed(settings.seed);
+	world.setAccidentCount(settings.accidentCount);
+}
+
+bool DomainRunner::run(Result& result)
+{
+	using Direction = Transport::Direction;
+
+	auto start = Clock::now();
+
+	world.initialize();
+
+	int rows = world.rowCount();
+	int firstRow = world.firstRow();
+	int lastRow = firstRow + world.ownedRowCount() - 1;
+	bool lastDomain = domain == (domainCount - 1);
+
+	for (int tick = 0; tick < tickCount; ++tick) {
+		if (domainCount == 1) {
+			world.update();
+			continue;
+		}
+
+		// the last domain gets its bottom border from the first domain's sweep
+		// of this tick, all others from the sweep below of the previous tick
+		if (tick > 0 || lastDomain) {
+			if (!receive(Direction::Down)) {
+				return false;
+			}
+		}
+		if (tick > 0 || domain > 0) {
+			if (!receive(Direction::Up)) {
+				return false;
+			}
+			world.setSeed(randomState);
+		}
+		applyAccidents(tick - 1);
+
+		world.sweep();
+
+		if (lastDomain) {
+			accidents = world.drawAccidents();
+			applyAccidents(tick);
+		}
+		randomState = world.randomState();
+
+		if (!send(Direction::Up, {firstRow, (firstRow + rows - 1) % rows}, false)) {
+			return false;
+		}
+		if (!send(Direction::Down, {lastRow, (lastRow + 1) % rows}, true)) {
+			return false;
+		}
+	}
+
+	// the accidents of the last tick still have to reach all domains above the
+	// last one, together with the rows changed by the sweeps below
+	if (domainCount > 1 && tickCount > 0 && !lastDomain) {
+		if (!receive(Direction::Down) || !receive(Direction::Up)) {
+			return false;
+		}
+		applyAccidents(tickCount - 1);
+		if ((domain + 1) < (domainCount - 1)) {
+			if (!send(Direction::Down, {}, true)) {
+				return false;
+			}
+		}
+	}
+
+	std::chrono::duration<double> elapsed = Clock::now() - start;
+
+	result.digest = world.digest();
+	result.population = world.population();
+	result.bytesSent = bytesSent;
+	result.communicationSeconds = communicationSeconds;
+	result.seconds = elapsed.count();
+	return true;
+}
+
+// message: size, token flag, random state, accidents, rows with their stamps
+bool DomainRunner::send(Transport::Direction direction, const std::vector<int>& rows, bool token)
+{
+	int columns = world.columnCount();
+
+	buffer.clear();
+	append<std::uint64_t>(buffer, 0);
+	append<std::uint8_t>(buffer, token);
+	append<std::uint32_t>(buffer, randomState);
+	append<std::int32_t>(buffer, token ? accidents.size() : 0);
+	if (token) {
+		for (Position position : accidents) {
+			append<std::int32_t>(buffer, position.row);
+			append<std::int32_t>(buffer, position.col);
+		}
+	}
+	append<std::int32_t>(buffer, rows.size());
+	for (int row : rows) {
+		append<std::int32_t>(buffer, row);
+		append<std::int32_t>(buffer, stamps[row]);
+		world.copyRow(row, rowCells.data());
+		const char* cells = reinterpret_cast<const char*>(rowCells.data());
+		buffer.insert(buffer.end(), cells, cells + columns * sizeof(Cell));
+	}
+	std::uint64_t size = buffer.size();
+	std::memcpy(&buffer[0], &size, sizeof(size));
+
+	auto start = Clock::now();
+	bool sent = transport.send(direction, buffer.data(), buffer.size());
+	std::chrono::duration<double> elapsed = Clock::now() - start;
+	communicationSeconds += elapsed.count();
+	bytesSent += size;
+	return sent;
+}
+
+bool DomainRunner::receive(Transport::Direction direction)
+{
+	int columns = world.columnCount();
+
+	auto start = Clock::now();
+	std::uint64_t size;
+	bool received = transport.receive(direction, &size, sizeof(size));
+	if (received) {
+		buffer.resize(size - sizeof(size));
+		received = transport.receive(direction, buffer.data(), buffer.size());
+	}
+	std::chrono::duration<double> elapsed = Clock::now() - start;
+	communicationSeconds += elapsed.count();
+	if (!received) {
+		return false;
+	}
+
+	const char* bytes = buffer.data();
+	bool token = extract<std::uint8_t>(bytes);
+	unsigned state = extract<std::uint32_t>(bytes);
+	int accidentCount = extract<std::int32_t>(bytes);
+	if (token) {
+		randomState = state;
+		accidents.clear();
+		for (int i = 0; i < accidentCount; ++i) {
+			int row = extract<std::int32_t>(bytes);
+			int col = extract<std::int32_t>(bytes);
+			accidents.push_back({row, col});
+		}
+	}
+	int rowCount = extract<std::int32_t>(bytes);
+	for (int i = 0; i < rowCount; ++i) {
+		int row = extract<std::int32_t>(bytes);
+		stamps[row] = extract<std::int32_t>(bytes);
+		std::memcpy(rowCells.data(), bytes, columns * sizeof(Cell));
+		world.setRow(row, rowCells.data());
+		bytes += columns * sizeof(Cell);
+	}
+	return true;
+}
+
+// Rows changed by a neighbor may already have the accidents, applying them
+// again after a sweep placed new organisms would not be the same.
+void DomainRunner::applyAccidents(int tick)
+{
+	if (tick < 0) {
+		return;
+	}
+	for (Position position : accidents) {
+		if (world.containsRow(position.row) && stamps[position.row] < tick) {
+			world.applyAccident(position);
+		}
+	}
+	for (int& stamp : stamps) {
+		stamp = std::max(stamp, tick);
+	}
+}
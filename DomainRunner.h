@@ -0,0 +1,71 @@
+#ifndef DOMAINRUNNER_H
+#define DOMAINRUNNER_H
+
+#include "GridWorld/GridWorld.h"
+#include "Transport.h"
+
+#include <cstdint>
+#include <vector>
+
+// Runs one domain of a GridWorld split into horizontal strips of whole block
+// rows. GridWorld updates in place in a single random sequence, so the strips
+// are swept one after another, in the order the whole world would sweep its
+// block rows: a token with the random state, the accidents of the previous
+// tick and the shared border rows goes down the ring, and after its sweep a
+// domain sends the rows it changed above back up. The result is the same as
+// in a single process, with the memory of the world distributed.
+class DomainRunner
+{
+public:
+	struct Settings
+	{
+		int rows;
+		int columns;
+		int population;
+		int accidentCount;
+		unsigned seed;
+		int tickCount;
+	};
+
+	struct Result
+	{
+		std::uint64_t digest;
+		GridWorld::Population population;
+		std::uint64_t bytesSent;
+		double communicationSeconds;
+		double seconds;
+	};
+
+	// false when the world has too few block rows for the domains
+	static bool partition(int rows, int domainCount, int domain, int& firstBlockRow, int& blockRowCount);
+
+	DomainRunner(const Settings& settings, int domain, int domainCount, Transport& transport);
+
+	bool run(Result& result);
+
+private:
+	bool send(Transport::Direction direction, const std::vector<int>& rows, bool token);
+
+	bool receive(Transport::Direction direction);
+
+	void applyAccidents(int tick);
+
+	int tickCount;
+	int domain;
+	int domainCount;
+	Transport& transport;
+
+	GridWorld world;
+
+	unsigned randomState;
+	std::vector<Position> accidents;
+	// last tick whose accidents are applied to the row
+	std::vector<int> stamps;
+
+	std::vector<char> buffer;
+	std::vector<Cell> rowCells;
+	std::uint64_t bytesSent;
+	double communicationSeconds;
+};
+
+#endif // DOMAINRUNNER_H
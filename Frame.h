@@ -0,0 +1,33 @@
+#ifndef FRAME_H
+#define FRAME_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// RGB image of a world at one pixel per cell, rasterized on the CPU. Row 0 is
+// on the top and column 0 on the right, like in the window.
+struct Frame
+{
+	void resize(int rows, int columns)
+	{
+		this->rows = rows;
+		this->columns = columns;
+		pixels.resize(std::size_t(rows) * columns * 3);
+	}
+
+	void setPixel(int row, int column, std::uint8_t red, std::uint8_t green, std::uint8_t blue)
+	{
+		std::uint8_t* pixel = &pixels[(std::size_t(row) * columns + (columns - 1 - column)) * 3];
+		pixel[0] = red;
+		pixel[1] = green;
+		pixel[2] = blue;
+	}
+
+	int tick;
+	int rows;
+	int columns;
+	std::vector<std::uint8_t> pixels;
+};
+
+#endif // FRAME_H
@@ -0,0 +1,109 @@
+#include "FrameWriter.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+FrameWriter::FrameWriter(const std::string& path, int period, int scale, Format format)
+	: path(path)
+	, period(std::max(period, 1))
+	, scale(std::max(scale, 1))
+	, format(format)
+	, imageRows(0)
+	, imageColumns(0)
+	, mWrittenCount(0)
+	, failed(false)
+	, pipeline([this](Frame& frame) { write(frame); }, 4)
+{
+}
+
+void FrameWriter::capture(const Simulation& world, int tick)
+{
+	if (tick % period != 0) {
+		return;
+	}
+
+	Frame* frame = pipeline.acquire();
+	if (!frame) {
+		return;
+	}
+	if (!world.rasterize(*frame)) {
+		return;
+	}
+	frame->tick = tick;
+	pipeline.submit();
+}
+
+void FrameWriter::finish()
+{
+	pipeline.finish();
+}
+
+// NOTE: a failed write is reported once, later frames are not written
+void FrameWriter::write(const Frame& frame)
+{
+	if (failed) {
+		return;
+	}
+
+	downsample(frame);
+	bool written = format == Format::Ppm ? writePpm(frame.tick) : writeRaw();
+	if (!written) {
+		std::cout << "Writing frame of tick " << frame.tick << " to " << path << " failed" << std::endl;
+		failed = true;
+		return;
+	}
+	mWrittenCount += 1;
+}
+
+void FrameWriter::downsample(const Frame& frame)
+{
+	imageRows = (frame.rows + scale - 1) / scale;
+	imageColumns = (frame.columns + scale - 1) / scale;
+	if (scale == 1) {
+		image = frame.pixels;
+		return;
+	}
+
+	image.resize(std::size_t(imageRows) * imageColumns * 3);
+	for (int r = 0; r < imageRows; ++r) {
+		int rows = std::min(scale, frame.rows - r * scale);
+		for (int c = 0; c < imageColumns; ++c) {
+			int columns = std::min(scale, frame.columns - c * scale);
+			int sums[3] = {0, 0, 0};
+			for (int i = 0; i < rows; ++i) {
+				const std::uint8_t* pixel = &frame.pixels[(std::size_t(r * scale + i) * frame.columns + c * scale) * 3];
+				for (int j = 0; j < columns * 3; ++j) {
+					sums[j % 3] += pixel[j];
+				}
+			}
+			std::uint8_t* pixel = &image[(std::size_t(r) * imageColumns + c) * 3];
+			for (int k = 0; k < 3; ++k) {
+				pixel[k] = std::uint8_t(sums[k] / (rows * columns));
+			}
+		}
+	}
+}
+
+bool FrameWriter::writePpm(int tick) const
+{
+	std::ostringstream name;
+	name << path << "-" << std::setw(8) << std::setfill('0') << tick << ".ppm";
+	std::ofstream file(name.str(), std::ios::binary);
+	file << "P6\n" << imageColumns << " " << imageRows << "\n255\n";
+	file.write(reinterpret_cast<const char*>(image.data()), image.size());
+	return bool(file);
+}
+
+// NOTE: the stream has no header, it can be read with
+// ffmpeg -f rawvideo -pixel_format rgb24 -video_size <columns>x<rows>
+bool FrameWriter::writeRaw()
+{
+	if (!stream.is_open()) {
+		stream.open(path, std::ios::binary);
+		std::cout << "raw video: " << imageColumns << "x" << imageRows << " rgb24" << std::endl;
+	}
+	stream.write(reinterpret_cast<const char*>(image.data()), image.size());
+	return bool(stream);
+}
@@ -0,0 +1,74 @@
+#ifndef FRAMEWRITER_H
+#define FRAMEWRITER_H
+
+#include "AnalysisPipeline.h"
+#include "Frame.h"
+#include "Simulation.h"
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Captures a world every period ticks, for runs without a display. The
+// simulation thread only rasterizes the world, the frames are downsampled and
+// written on a background thread, either as numbered PPM images or appended
+// to one raw RGB24 video stream. Frames are dropped while the writer is
+// behind.
+class FrameWriter
+{
+public:
+	enum class Format
+	{
+		Ppm,
+		Raw,
+	};
+
+	// Images are written to <path>-<tick>.ppm, the stream to path. A scale
+	// above 1 averages squares of scale x scale cells into a pixel.
+	FrameWriter(const std::string& path, int period, int scale, Format format);
+
+	// captures the ticks that are multiples of the period
+	void capture(const Simulation& world, int tick);
+
+	// writes the frames still queued
+	void finish();
+
+	int writtenCount() const
+	{
+		return mWrittenCount;
+	}
+
+	std::uint64_t droppedCount() const
+	{
+		return pipeline.droppedCount();
+	}
+
+private:
+	void write(const Frame& frame);
+
+	void downsample(const Frame& frame);
+
+	bool writePpm(int tick) const;
+
+	bool writeRaw();
+
+private:
+	std::string path;
+	int period;
+	int scale;
+	Format format;
+
+	// only used by the writer thread
+	std::vector<std::uint8_t> image;
+	int imageRows;
+	int imageColumns;
+	std::ofstream stream;
+	int mWrittenCount;
+	bool failed;
+
+	// NOTE: last, its worker uses the members above
+	AnalysisPipeline<Frame> pipeline;
+};
+
+#endif // FRAMEWRITER_H
@@ -1,14 +1,27 @@
 #include "GameOfLifeWorld.h"
 
+#include <algorithm>
+
 namespace GameOfLife {
 
 GameOfLifeWorld::GameOfLifeWorld()
-	: rowCount(128)
-	, columnCount(128)
-	, initialLivingCellCount(rowCount * columnCount / 4)
+	: GameOfLifeWorld(128, 128)
+{
+}
+
+GameOfLifeWorld::GameOfLifeWorld(int rowCount, int columnCount)
+	: GameOfLifeWorld(rowCount, columnCount, rowCount * columnCount / 4)
+{
+}
+
+GameOfLifeWorld::GameOfLifeWorld(int rowCount, int columnCount, int initialLivingCellCount)
+	: rowCount(rowCount)
+	, columnCount(columnCount)
+	, initialLivingCellCount(initialLivingCellCount)
 	, randomToggleCellCount(1)
-	, rowDistribution(0, columnCount - 1)
-	, columnDistribution(0, rowCount - 1)
+	, livingCount(0)
+	, rowDistribution(0, rowCount - 1)
+	, columnDistribution(0, columnCount - 1)
 	, currentGrid(std::make_unique<Grid<Cell>>(rowCount, columnCount))
 	, updateGrid(std::make_unique<Grid<Cell>>(rowCount, columnCount))
 {
@@ -22,14 +35,18 @@ bool GameOfLifeWorld::initialize()
 	for (int i = 0; i < initialLivingCellCount; ++i) {
 		currentGrid->at(randomAvailablePosition()) = 1;
 	}
+	livingCount = initialLivingCellCount;
 
+#ifndef EVOLUTION_HEADLESS
 	renderer.initialize();
+#endif
 
 	return true;
 }
 
 void GameOfLifeWorld::update()
 {
+	int living = 0;
 	for (int r = 0; r < rowCount; ++r) {
 		for (int c = 0; c < columnCount; ++c) {
 			Position p(r, c);
@@ -53,20 +70,70 @@ void GameOfLifeWorld::update()
 				}
 			}
 		}
+		// NOTE: counted on the row just written, so the loop above stays as it is
+		const Cell* row = &updateGrid->at(r, 0);
+		living += columnCount - int(std::count(row, row + columnCount, Cell(0)));
 	}
 
 	for (int i = 0; i < randomToggleCellCount; ++i) {
 		Position p = randomPosition();
 		Cell cell = updateGrid->at(p);
 		updateGrid->at(p) = !cell;
+		living += cell ? -1 : 1;
 	}
+	livingCount = living;
 
 	std::swap(updateGrid, currentGrid);
 }
 
+void GameOfLifeWorld::snapshot()
+{
+#ifndef EVOLUTION_HEADLESS
+	renderer.snapshot(*this);
+#endif
+}
+
 void GameOfLifeWorld::render() const
 {
-	renderer.render(*this);
+#ifndef EVOLUTION_HEADLESS
+	renderer.render();
+#endif
+}
+
+// NOTE: colors of the renderer
+bool GameOfLifeWorld::rasterize(Frame& frame) const
+{
+	frame.resize(rowCount, columnCount);
+
+	#pragma omp parallel for schedule(dynamic)
+	for (int r = 0; r < rowCount; ++r) {
+		for (int c = 0; c < columnCount; ++c) {
+			if (currentGrid->at(r, c)) {
+				frame.setPixel(r, c, 0, 255, 0);
+			} else {
+				frame.setPixel(r, c, 128, 0, 0);
+			}
+		}
+	}
+
+	return true;
+}
+
+void GameOfLifeWorld::setViewport(const Viewport& viewport)
+{
+#ifndef EVOLUTION_HEADLESS
+	renderer.setViewport(viewport);
+#endif
+}
+
+int GameOfLifeWorld::cellCount() const
+{
+	return rowCount * columnCount;
+}
+
+int GameOfLifeWorld::organismCount() const
+{
+	return livingCount;
 }
 
 Position GameOfLifeWorld::randomPosition() const
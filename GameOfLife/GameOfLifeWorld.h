@@ -8,7 +8,9 @@
 #include "../Position.h"
 #include "../Simulation.h"
 
+#ifndef EVOLUTION_HEADLESS
 #include "GameOfLifeWorldRenderer.h"
+#endif
 
 #include <memory>
 #include <random>
@@ -21,12 +23,26 @@ public:
 
 	GameOfLifeWorld();
 
+	GameOfLifeWorld(int rowCount, int columnCount);
+
+	GameOfLifeWorld(int rowCount, int columnCount, int initialLivingCellCount);
+
 	virtual bool initialize() override;
 
 	virtual void update() override;
 
+	virtual void snapshot() override;
+
 	virtual void render() const override;
 
+	virtual bool rasterize(Frame& frame) const override;
+
+	virtual void setViewport(const Viewport& viewport) override;
+
+	virtual int cellCount() const override;
+
+	virtual int organismCount() const override;
+
 private:
 	Position randomPosition() const;
 
@@ -40,6 +56,9 @@ private:
 	int initialLivingCellCount;
 	int randomToggleCellCount;
 
+	// kept up to date by update()
+	int livingCount;
+
 	mutable std::minstd_rand0 random; // NOTE: fastest from std
 	mutable ModuloIntDistribution<> rowDistribution;
 	mutable ModuloIntDistribution<> columnDistribution;
@@ -47,8 +66,10 @@ private:
 	std::unique_ptr<Grid<Cell>> currentGrid;
 	std::unique_ptr<Grid<Cell>> updateGrid;
 
+#ifndef EVOLUTION_HEADLESS
 	friend class GameOfLifeWorldRenderer;
 	GameOfLifeWorldRenderer renderer;
+#endif
 };
 
 } // namespace GameOfLife
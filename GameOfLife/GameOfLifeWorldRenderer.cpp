@@ -2,6 +2,7 @@
 
 #include "GameOfLifeWorld.h"
 
+#include <algorithm>
 #include <cstddef>
 
 namespace GameOfLife {
@@ -14,8 +15,20 @@ void GameOfLifeWorldRenderer::initialize()
 {
 	initializeShaders();
 
-	instanceVertexBufferObject = VertexBufferObject::generate();
+#if GAMEOFLIFE_RENDER_USE_TEXTURE
+	cellTexture = Texture::generate();
 
+	// the area the instances cover
+	GLfloat quadVertices[] = {
+		-0.955f,  0.955f,
+		0.955f, -0.955f,
+		-0.955f, -0.955f,
+
+		-0.955f,  0.955f,
+		0.955f, -0.955f,
+		0.955f,  0.955f,
+	};
+#else
 	GLfloat quadVertices[] = {
 		-0.005f,  0.005f,
 		0.005f, -0.005f,
@@ -25,6 +38,7 @@ void GameOfLifeWorldRenderer::initialize()
 		0.005f, -0.005f,
 		0.005f,  0.005f,
 	};
+#endif
 
 	quadVertexArrayObject = VertexArrayObject::generate();
 	quadVertexBufferObject = VertexBufferObject::generate();
@@ -34,16 +48,94 @@ void GameOfLifeWorldRenderer::initialize()
 	glEnableVertexAttribArray(0);
 	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(GLfloat), (GLvoid*)0);
 
-	instanceVertexBufferObject.bind();
-	glEnableVertexAttribArray(1);
-	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Quad), (GLvoid*)offsetof(Quad, position));
-	glVertexAttribDivisor(1, 1);
-	glEnableVertexAttribArray(2);
-	glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Quad), (GLvoid*)offsetof(Quad, color));
-	glVertexAttribDivisor(2, 1);
-	instanceVertexBufferObject.unbind();
+	quadVertexArrayObject.unbind();
+}
+
+#if GAMEOFLIFE_RENDER_USE_TEXTURE
+
+// NOTE: column 0 is on the right and row 0 on the top, like the instances.
+// The visible part of the world wraps around.
+void GameOfLifeWorldRenderer::initializeShaders()
+{
+	VertexShader vertexShader(
+		"#version 330 core\n"
+		"layout (location = 0) in vec2 position;\n"
+		"out vec2 fPosition;\n"
+		"void main()\n"
+		"{\n"
+		"	gl_Position = vec4(position, 0.0f, 1.0f);\n"
+		"	fPosition = position;\n"
+		"}\n"
+	);
+	FragmentShader fragmentShader(
+		"#version 330 core\n"
+		"uniform sampler2D cells;\n"
+		"uniform vec3 viewport;\n"
+		"in vec2 fPosition;\n"
+		"out vec4 color;\n"
+		"void main()\n"
+		"{\n"
+		"	vec2 visible = (0.955f - fPosition) / 1.91f;\n"
+		"	vec2 world = fract(viewport.xy + (visible - 0.5f) / viewport.z);\n"
+		"	ivec2 size = textureSize(cells, 0);\n"
+		"	ivec2 cell = min(ivec2(world * vec2(size)), size - 1);\n"
+		"	if (texelFetch(cells, cell, 0).r > 0.0f) {\n"
+		"		color = vec4(0.0f, 1.0f, 0.0f, 1.0f);\n"
+		"	} else {\n"
+		"		color = vec4(0.5f, 0.0f, 0.0f, 1.0f);\n"
+		"	}\n"
+		"}\n"
+	);
+
+	program = ShaderProgram(vertexShader, fragmentShader);
+	viewportLocation = program.uniformLocation("viewport");
+}
 
+void GameOfLifeWorldRenderer::setViewport(const Viewport& viewport)
+{
+	this->viewport = viewport;
+}
+
+void GameOfLifeWorldRenderer::snapshot(const GameOfLifeWorld& world)
+{
+	if (!snapshots.isConsumed()) {
+		return;
+	}
+
+	const Grid<Cell>* grid = world.currentGrid.get();
+	int rowCount = world.rowCount;
+	int columnCount = world.columnCount;
+	image.resize(rowCount, columnCount);
+	Cell* cells = image.texels();
+	for (int r = 0; r < rowCount; ++r) {
+		for (int c = 0; c < columnCount; ++c) {
+			cells[r * columnCount + c] = grid->at(r, c);
+		}
+	}
+
+	image.pack(snapshots.back());
+	snapshots.publish();
+}
+
+void GameOfLifeWorldRenderer::render() const
+{
+	program.use();
+	if (snapshots.update()) {
+		cellTexture.setImage<Cell>(GL_R8, GL_RED, GL_UNSIGNED_BYTE, snapshots.front());
+	}
+	glUniform3f(viewportLocation, viewport.centerX, viewport.centerY, viewport.zoom);
+	cellTexture.bind();
+	quadVertexArrayObject.bind();
+	glDrawArrays(GL_TRIANGLES, 0, 6);
 	quadVertexArrayObject.unbind();
+	Texture::unbind();
+}
+
+#else // GAMEOFLIFE_RENDER_USE_TEXTURE
+
+// NOTE: the instances always cover the whole world
+void GameOfLifeWorldRenderer::setViewport(const Viewport& /*viewport*/)
+{
 }
 
 void GameOfLifeWorldRenderer::initializeShaders()
@@ -73,8 +165,28 @@ void GameOfLifeWorldRenderer::initializeShaders()
 	program = ShaderProgram(vertexShader, fragmentShader);
 }
 
-void GameOfLifeWorldRenderer::render(const GameOfLifeWorld& world) const
+// NOTE: every new snapshot is written to another region, a grown buffer is
+// another buffer object
+void GameOfLifeWorldRenderer::setInstanceAttributes() const
+{
+	GLintptr offset = instanceBuffer.offset();
+	instanceBuffer.bind();
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Quad), (GLvoid*)(offset + offsetof(Quad, position)));
+	glVertexAttribDivisor(1, 1);
+	glEnableVertexAttribArray(2);
+	glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Quad), (GLvoid*)(offset + offsetof(Quad, color)));
+	glVertexAttribDivisor(2, 1);
+	VertexBufferObject::unbind();
+}
+
+void GameOfLifeWorldRenderer::snapshot(const GameOfLifeWorld& world)
 {
+	if (!snapshots.isConsumed()) {
+		return;
+	}
+
+	std::vector<Quad>& quads = snapshots.back();
 	quads.clear();
 
 	const Grid<Cell>* grid = world.currentGrid.get();
@@ -92,12 +204,25 @@ void GameOfLifeWorldRenderer::render(const GameOfLifeWorld& world) const
 		}
 	}
 
+	snapshots.publish();
+}
+
+void GameOfLifeWorldRenderer::render() const
+{
 	program.use();
 	quadVertexArrayObject.bind();
-	instanceVertexBufferObject.setData(quads, GL_DYNAMIC_DRAW);
-	glDrawArraysInstanced(GL_TRIANGLES, 0, 6, quads.size());
+	if (snapshots.update()) {
+		const std::vector<Quad>& quads = snapshots.front();
+		std::copy(quads.begin(), quads.end(), instanceBuffer.map(quads.size()));
+		instanceBuffer.unmap();
+		setInstanceAttributes();
+	}
+	glDrawArraysInstanced(GL_TRIANGLES, 0, 6, instanceBuffer.count());
+	instanceBuffer.fence();
 	quadVertexArrayObject.unbind();
 }
 
+#endif // GAMEOFLIFE_RENDER_USE_TEXTURE
+
 } // namespace GameOfLife
 
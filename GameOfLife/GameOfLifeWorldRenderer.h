@@ -1,15 +1,24 @@
 #ifndef GAMEOFLIFEWORLDRENDERER_H
 #define GAMEOFLIFEWORLDRENDERER_H
 
+#include "Cell.h"
+
 #include "../Buffer.h"
 #include "../Shader.h"
+#include "../Texture.h"
+#include "../TripleBuffer.h"
 #include "../VertexArrayObject.h"
+#include "../Viewport.h"
 
 #include <glm/vec2.hpp>
 #include <glm/vec3.hpp>
 
 #include <vector>
 
+// one byte per cell in a texture colored by the fragment shader and drawn as
+// a single quad, instead of a 20 byte instance per cell
+#define GAMEOFLIFE_RENDER_USE_TEXTURE 1
+
 namespace GameOfLife {
 
 class GameOfLifeWorld;
@@ -22,26 +31,44 @@ class GameOfLifeWorldRenderer
 		glm::vec3 color;
 	};
 
+
 public:
 
 	GameOfLifeWorldRenderer();
 
 	void initialize();
 
-	void render(const GameOfLifeWorld& world) const;
+	void snapshot(const GameOfLifeWorld& world);
+
+	void render() const;
+
+	void setViewport(const Viewport& viewport);
 
 private:
 
 	void initializeShaders();
 
+#if !GAMEOFLIFE_RENDER_USE_TEXTURE
+	void setInstanceAttributes() const;
+#endif
+
 private:
 
 	ShaderProgram program;
-	VertexBufferObject instanceVertexBufferObject;
 	VertexArrayObject quadVertexArrayObject;
 	VertexBufferObject quadVertexBufferObject;
 
-	mutable std::vector<Quad> quads;
+#if GAMEOFLIFE_RENDER_USE_TEXTURE
+	GLint viewportLocation;
+	Viewport viewport;
+	mutable Texture cellTexture;
+	// only written by snapshot()
+	TiledImage<Cell> image;
+	mutable TripleBuffer<TiledImage<Cell>::Changes> snapshots;
+#else
+	mutable StreamingVertexBuffer<Quad> instanceBuffer;
+	mutable TripleBuffer<std::vector<Quad>> snapshots;
+#endif
 };
 
 } // namespace GameOfLife
@@ -2,12 +2,39 @@
 #define CELL_H
 
 #include <cassert>
+#include <cstdint>
+#include <utility>
 
+// Layout of the cells GridWorld is built with. Every layout is a template
+// below, evolution-bench runs them side by side.
+
+// cells are a pointer to their contents
+#ifndef CELL_USE_PIMPL
 #define CELL_USE_PIMPL 0
+#endif
 
+// organisms are allocated when they are set and freed when removed
+#ifndef CELL_ORGANISM_USE_PTR
 #define CELL_ORGANISM_USE_PTR 0
+#endif
 
+// with CELL_ORGANISM_USE_PTR, organisms are allocated with the cell and a
+// second pointer marks whether they are there
+#ifndef CELL_ORGANISM_USE_DOUBLE_PTR
 #define CELL_ORGANISM_USE_DOUBLE_PTR 0
+#endif
+
+// herbivores and carnivores carry the node of their lineage in the
+// phylogeny, 0 leaves out the field and all the tracking
+#ifndef CELL_ORGANISM_USE_LINEAGE
+#define CELL_ORGANISM_USE_LINEAGE 0
+#endif
+
+// plants too, with CELL_ORGANISM_USE_LINEAGE. Plants make up nearly all the
+// births and deaths, following them slows the ticks by about a third.
+#ifndef CELL_PLANT_USE_LINEAGE
+#define CELL_PLANT_USE_LINEAGE 0
+#endif
 
 struct Organism
 {
@@ -37,6 +64,10 @@ struct Plant : public Organism
 {
 public:
 	using Organism::Organism;
+
+#if CELL_ORGANISM_USE_LINEAGE && CELL_PLANT_USE_LINEAGE
+	std::uint32_t lineage;
+#endif
 };
 
 struct Herbivore : public Organism
@@ -53,70 +84,82 @@ public:
 	}
 
 	int feastSize;
+#if CELL_ORGANISM_USE_LINEAGE
+	std::uint32_t lineage;
+#endif
 };
 
 struct Carnivore : public Organism
 {
 public:
 	using Organism::Organism;
-};
-
-#if CELL_ORGANISM_USE_PTR
 
-#if CELL_ORGANISM_USE_DOUBLE_PTR
+#if CELL_ORGANISM_USE_LINEAGE
+	std::uint32_t lineage;
+#endif
+};
 
+// organism in the cell, with a flag whether it is there
 template <class OrganismType>
-class OrganismHelper
+class InlineOrganism
 {
 public:
-	OrganismHelper()
-		: mRetainedOrganism(new OrganismType())
-	{
-	}
-
-	~OrganismHelper()
-	{
-		delete mRetainedOrganism;
-	}
-
 	inline void setOrganism(const OrganismType& organism)
 	{
-		mOrganism = mRetainedOrganism;
-		*mOrganism = organism;
+		mHasOrganism = true;
+		mOrganism = organism;
 	}
 
 	inline void removeOrganism()
 	{
-		mOrganism = nullptr;
+		mHasOrganism = false;
 	}
 
 	inline bool hasOrganism() const
 	{
-		return mOrganism != nullptr;
+		return mHasOrganism;
 	}
 
 	inline OrganismType* organism()
 	{
-		return mOrganism;
+		return &mOrganism;
 	}
 
 	inline const OrganismType* organism() const
 	{
-		return mOrganism;
+		return &mOrganism;
 	}
 
 private:
-	OrganismType *mOrganism = nullptr;
-	OrganismType *mRetainedOrganism;
+	bool mHasOrganism = false;
+	OrganismType mOrganism;
 };
 
-#else // CELL_ORGANISM_USE_DOUBLE_PTR
-
+// organism allocated when it is set and freed when it is removed
 template <class OrganismType>
-class OrganismHelper
+class HeapOrganism
 {
 public:
-	~OrganismHelper()
+	HeapOrganism()
+	{
+	}
+
+	HeapOrganism(const HeapOrganism& other)
+		: mOrganism(other.hasOrganism() ? new OrganismType(*other.mOrganism) : nullptr)
+	{
+	}
+
+	HeapOrganism& operator=(const HeapOrganism& other)
+	{
+		if (other.hasOrganism()) {
+			setOrganism(*other.mOrganism);
+		} else {
+			removeOrganism();
+		}
+		return *this;
+	}
+
+	~HeapOrganism()
 	{
 		delete mOrganism;
 	}
@@ -155,52 +198,71 @@ private:
 	OrganismType *mOrganism = nullptr;
 };
 
-#endif // CELL_ORGANISM_USE_DOUBLE_PTR
-
-#else // CELL_ORGANISM_USE_PTR
-
+// organism allocated with the cell and kept, the first pointer is set to it
+// while it is there
 template <class OrganismType>
-class OrganismHelper
+class RetainedOrganism
 {
 public:
+	RetainedOrganism()
+		: mRetainedOrganism(new OrganismType())
+	{
+	}
+
+	RetainedOrganism(const RetainedOrganism& other)
+		: RetainedOrganism()
+	{
+		*this = other;
+	}
+
+	RetainedOrganism& operator=(const RetainedOrganism& other)
+	{
+		if (other.hasOrganism()) {
+			setOrganism(*other.mOrganism);
+		} else {
+			removeOrganism();
+		}
+		return *this;
+	}
+
+	~RetainedOrganism()
+	{
+		delete mRetainedOrganism;
+	}
+
 	inline void setOrganism(const OrganismType& organism)
 	{
-		mHasOrganism = true;
-		mOrganism = organism;
+		mOrganism = mRetainedOrganism;
+		*mOrganism = organism;
 	}
 
 	inline void removeOrganism()
 	{
-		mHasOrganism = false;
+		mOrganism = nullptr;
 	}
 
 	inline bool hasOrganism() const
 	{
-		return mHasOrganism;
+		return mOrganism != nullptr;
 	}
 
 	inline OrganismType* organism()
 	{
-		return &mOrganism;
+		return mOrganism;
 	}
 
 	inline const OrganismType* organism() const
 	{
-		return &mOrganism;
+		return mOrganism;
 	}
 
 private:
-	bool mHasOrganism = false;
-	OrganismType mOrganism;
+	OrganismType *mOrganism = nullptr;
+	OrganismType *mRetainedOrganism;
 };
 
-#endif // CELL_ORGANISM_USE_PTR
-
-#if CELL_USE_PIMPL
-class CellHelper
-#else
-class Cell
-#endif
+template <template <class> class OrganismStorage>
+class BasicCell
 {
 public:
 
@@ -313,63 +375,54 @@ public:
 
 private:
 	bool mAccident = false;
-	OrganismHelper<Plant> mPlantHelper;
-	OrganismHelper<Herbivore> mHerbivoreHelper;
-	OrganismHelper<Carnivore> mCarnivoreHelper;
+	OrganismStorage<Plant> mPlantHelper;
+	OrganismStorage<Herbivore> mHerbivoreHelper;
+	OrganismStorage<Carnivore> mCarnivoreHelper;
 };
 
-#if CELL_USE_PIMPL
-
-class Cell
+// cell allocated on its own, a moved from cell is only assigned to or
+// destroyed
+template <class CellHelper>
+class PimplCell
 {
 public:
-	Cell()
+	PimplCell()
 		: p(new CellHelper)
 	{
 	}
 
-	Cell(const Cell& other)
-		: p(new CellHelper)
+	PimplCell(const PimplCell& other)
+		: p(new CellHelper(*other.p))
 	{
-		*p = *other.p;
 	}
 
-	Cell(Cell&& other)
+	PimplCell(PimplCell&& other)
 		: p(other.p)
 	{
 		other.p = nullptr;
 	}
 
-	Cell& operator=(const Cell& other)
+	PimplCell& operator=(const PimplCell& other)
 	{
-		*p = *other.p;
+		if (p) {
+			*p = *other.p;
+		} else {
+			p = new CellHelper(*other.p);
+		}
 		return *this;
 	}
 
-	Cell& operator=(Cell&& other)
+	PimplCell& operator=(PimplCell&& other)
 	{
-		p = other.p;
-		other.p = nullptr;
+		std::swap(p, other.p);
 		return *this;
 	}
 
-	~Cell()
+	~PimplCell()
 	{
 		delete p;
 	}
 
-	// accident
-
-	inline bool& accident()
-	{
-		return p->accident();
-	}
-
-	inline bool accident() const
-	{
-		return p->accident();
-	}
-
 	// plant
 
 	inline void setPlant(const Plant& plant)
@@ -467,6 +520,25 @@ private:
 	CellHelper *p;
 };
 
-#endif // CELL_USE_PIMPL
+typedef BasicCell<InlineOrganism> InlineCell;
+typedef BasicCell<HeapOrganism> HeapCell;
+typedef BasicCell<RetainedOrganism> RetainedCell;
+typedef PimplCell<InlineCell> PimplInlineCell;
+typedef PimplCell<HeapCell> PimplHeapCell;
+typedef PimplCell<RetainedCell> PimplRetainedCell;
+
+#if CELL_ORGANISM_USE_PTR && CELL_ORGANISM_USE_DOUBLE_PTR
+typedef RetainedCell CellContents;
+#elif CELL_ORGANISM_USE_PTR
+typedef HeapCell CellContents;
+#else
+typedef InlineCell CellContents;
+#endif
+
+#if CELL_USE_PIMPL
+typedef PimplCell<CellContents> Cell;
+#else
+typedef CellContents Cell;
+#endif
 
 #endif // CELL_H
@@ -0,0 +1,95 @@
+#include "DensityPyramid.h"
+
+#include "GridWorld.h"
+
+#include <algorithm>
+
+DensityPyramid::DensityPyramid()
+	: cellRows(0)
+	, cellColumns(0)
+	, mLevel(0)
+	, tileRows(0)
+	, tileColumns(0)
+{
+}
+
+void DensityPyramid::build(const GridWorld& gridWorld, int level)
+{
+	cellRows = gridWorld.rows;
+	cellColumns = gridWorld.columns;
+
+	// NOTE: blocks are squares of a power of two cells on a side, so tiles up
+	// to the block size never cross blocks
+	int blockLevel = 0;
+	while ((1 << blockLevel) < GridWorld::BLOCK_ROWS) {
+		++blockLevel;
+	}
+	reset(std::min(level, blockLevel));
+
+	const BlockMap<Cell, GridWorld::BLOCK_ROWS, GridWorld::BLOCK_COLUMNS>& cellBlocks = gridWorld.cellBlocks;
+	#pragma omp parallel for collapse(2) schedule(dynamic)
+	for (int r = 0; r < cellBlocks.rows(); ++r) {
+		for (int c = 0; c < cellBlocks.columns(); ++c) {
+			const Block<Cell>& block = cellBlocks.block(r, c);
+			for (int i = 0; i < block.rows(); ++i) {
+				Tile* row = tiles.data() + ((r * GridWorld::BLOCK_ROWS + i) >> mLevel) * tileColumns;
+				for (int j = 0; j < block.columns(); ++j) {
+					const Cell &cell = block.cell(i, j);
+					Tile& tile = row[(c * GridWorld::BLOCK_COLUMNS + j) >> mLevel];
+					if (cell.hasPlant()) {
+						tile.plants += 1;
+						tile.energy += cell.plant()->energy;
+					}
+					if (cell.hasHerbivore()) {
+						tile.herbivores += 1;
+						tile.energy += cell.herbivore()->energy;
+					}
+					if (cell.hasCarnivore()) {
+						tile.carnivores += 1;
+						tile.energy += cell.carnivore()->energy;
+					}
+				}
+			}
+		}
+	}
+
+	while (mLevel < level) {
+		reduce();
+	}
+}
+
+int DensityPyramid::cellCount(int row, int column) const
+{
+	int size = 1 << mLevel;
+	return std::min(size, cellRows - row * size) * std::min(size, cellColumns - column * size);
+}
+
+void DensityPyramid::reset(int level)
+{
+	mLevel = level;
+	tileRows = (cellRows + (1 << level) - 1) >> level;
+	tileColumns = (cellColumns + (1 << level) - 1) >> level;
+	tiles.assign(tileRows * tileColumns, {0, 0, 0, 0});
+}
+
+void DensityPyramid::reduce()
+{
+	int rows = (tileRows + 1) / 2;
+	int columns = (tileColumns + 1) / 2;
+	reducedTiles.assign(rows * columns, {0, 0, 0, 0});
+	for (int r = 0; r < tileRows; ++r) {
+		for (int c = 0; c < tileColumns; ++c) {
+			const Tile& tile = tiles[r * tileColumns + c];
+			Tile& reducedTile = reducedTiles[(r / 2) * columns + c / 2];
+			reducedTile.plants += tile.plants;
+			reducedTile.herbivores += tile.herbivores;
+			reducedTile.carnivores += tile.carnivores;
+			reducedTile.energy += tile.energy;
+		}
+	}
+
+	std::swap(tiles, reducedTiles);
+	tileRows = rows;
+	tileColumns = columns;
+	mLevel += 1;
+}
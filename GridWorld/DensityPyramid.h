@@ -0,0 +1,73 @@
+#ifndef DENSITYPYRAMID_H
+#define DENSITYPYRAMID_H
+
+#include "Cell.h"
+
+#include <cstdint>
+#include <vector>
+
+template <class CellType>
+class BasicGridWorld;
+
+typedef BasicGridWorld<Cell> GridWorld;
+
+// Organism counts and energy of square tiles of 2^level cells on a side, for
+// drawing the world zoomed out. Up to the block size the tiles are summed
+// block by block in parallel, every block only writes its own tiles. Larger
+// tiles are reduced 2x2 from one tile per block, level by level.
+class DensityPyramid
+{
+public:
+	struct Tile
+	{
+		int plants;
+		int herbivores;
+		int carnivores;
+		std::int64_t energy;
+	};
+
+	DensityPyramid();
+
+	void build(const GridWorld& gridWorld, int level);
+
+	int level() const
+	{
+		return mLevel;
+	}
+
+	int rows() const
+	{
+		return tileRows;
+	}
+
+	int columns() const
+	{
+		return tileColumns;
+	}
+
+	const Tile& tile(int row, int column) const
+	{
+		return tiles[row * tileColumns + column];
+	}
+
+	// edge tiles are only partly in the world
+	int cellCount(int row, int column) const;
+
+private:
+	void reset(int level);
+
+	void reduce();
+
+private:
+	int cellRows;
+	int cellColumns;
+
+	int mLevel;
+	int tileRows;
+	int tileColumns;
+
+	std::vector<Tile> tiles;
+	std::vector<Tile> reducedTiles;
+};
+
+#endif // DENSITYPYRAMID_H
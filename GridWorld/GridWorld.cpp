@@ -1,89 +1,171 @@
 #include "GridWorld.h"
 
+#include "../PhaseTrace.h"
 #include "../Restorer.h"
 
 #include <cmath>
 #include <random>
+#include <sstream>
+#include <unordered_set>
 
 #include <iostream>
 
-GridWorld::GridWorld()
-	: rows(128)
-	, columns(128)
-	, cellBlocks(rows, columns)
+template <class CellType>
+BasicGridWorld<CellType>::BasicGridWorld()
+	: BasicGridWorld(128, 128)
+{
+}
+
+template <class CellType>
+BasicGridWorld<CellType>::BasicGridWorld(int rows, int columns)
+	: BasicGridWorld(rows, columns, defaultPlantCount(rows, columns))
+{
+}
+
+template <class CellType>
+BasicGridWorld<CellType>::BasicGridWorld(int rows, int columns, int plantCount)
+	: BasicGridWorld(rows, columns, plantCount, 0, blockRowCount(rows))
+{
+}
+
+template <class CellType>
+BasicGridWorld<CellType>::BasicGridWorld(int rows, int columns, int plantCount, int firstBlockRow, int blockRowCount)
+	: rows(rows)
+	, columns(columns)
+	, plantCount(plantCount)
+	, herbivoreCount(plantCount * 2 / 5)
+	, carnivoreCount(plantCount / 5)
+	, accidentCount(5)
+	, mFirstRow(firstBlockRow * BLOCK_ROWS)
+	, mOwnedRowCount(std::min(rows, (firstBlockRow + blockRowCount) * BLOCK_ROWS) - mFirstRow)
+	, cellBlocks(columns, mOwnedRowCount)
 	, xPositionDistribution(0, columns - 1)
 	, yPositionDistribution(0, rows - 1)
 	, positionOffsetDistribution(0, 7)
 	, geneOffsetDistribution(-1, 1)
+	, statisticsStarted(false)
+#if CELL_ORGANISM_USE_LINEAGE
+	, lineageTick(0)
+#endif
 {
 	std::random_device rd;
 	int seed = rd();
 	random.seed(seed);
+
+	if (mOwnedRowCount < rows) {
+		haloAbove.resize(columns);
+		haloBelow.resize(columns);
+	}
 }
 
-bool GridWorld::initialize()
+// Every domain makes all the draws, so the world is the same however it is
+// split. Herbivores and carnivores are tracked by position, not through the
+// cells, since a domain only has its own rows.
+template <class CellType>
+bool BasicGridWorld<CellType>::initialize()
 {
-	std::cout << "sizeof(Cell): " << sizeof(Cell) << std::endl;
+	//std::cout << "sizeof(CellType): " << sizeof(CellType) << std::endl;
+
+	std::unordered_set<int> animalPositions;
 
 	std::uniform_int_distribution<> plantDistribution(1, 10);
-	for (int i = 0; i < 2500; ++i) {
+	for (int i = 0; i < plantCount; ++i) {
 		auto position = randomPosition();
-		Cell &cell = cellBlocks.cell(position);
-		cell.setPlant({
+		Plant plant = {
 			plantDistribution(random),
 			plantDistribution(random),
 			plantDistribution(random),
 			1, 1, 1
-		});
+		};
+		if (containsRow(position.row)) {
+			CellType& cell = cellAt(position);
+			if (cell.hasPlant()) {
+				died(*cell.plant());
+			}
+			founded(plant);
+			cell.setPlant(plant);
+			born(plant);
+		}
 	}
 
 	std::uniform_int_distribution<> herbivoreDistribution(10, 100);
-	for (int i = 0; i < 1000; ++i) {
+	for (int i = 0; i < herbivoreCount; ++i) {
 		Position position;
 		do {
 			position = randomPosition();
-		} while (cellBlocks.cell(position).hasHerbivore() || cellBlocks.cell(position).hasCarnivore());
-		Cell &cell = cellBlocks.cell(position);
-		cell.setHerbivore({
+		} while (animalPositions.count(position.row * columns + position.col));
+		animalPositions.insert(position.row * columns + position.col);
+		Herbivore herbivore = {
 			herbivoreDistribution(random),
 			herbivoreDistribution(random),
 			herbivoreDistribution(random),
 			1, 1, 1,
 			1
-		});
+		};
+		if (containsRow(position.row)) {
+			founded(herbivore);
+			cellAt(position).setHerbivore(herbivore);
+			born(herbivore);
+		}
 	}
 
 	std::uniform_int_distribution<> carnivoreDistribution(10, 100);
-	for (int i = 0; i < 500; ++i) {
+	for (int i = 0; i < carnivoreCount; ++i) {
 		Position position;
 		do {
 			position = randomPosition();
-		} while (cellBlocks.cell(position).hasHerbivore() || cellBlocks.cell(position).hasCarnivore());
-		Cell &cell = cellBlocks.cell(position);
-		cell.setCarnivore({
+		} while (animalPositions.count(position.row * columns + position.col));
+		animalPositions.insert(position.row * columns + position.col);
+		Carnivore carnivore = {
 			carnivoreDistribution(random),
 			carnivoreDistribution(random),
 			carnivoreDistribution(random),
 			1, 1, 1
-		});
+		};
+		if (containsRow(position.row)) {
+			founded(carnivore);
+			cellAt(position).setCarnivore(carnivore);
+			born(carnivore);
+		}
 	}
 
+#ifndef EVOLUTION_HEADLESS
 	renderer.initialize();
+#endif
 
 	return true;
 }
 
-void GridWorld::update()
+template <class CellType>
+void BasicGridWorld<CellType>::update()
+{
+	PHASE_SCOPE("update");
+
+	sweep();
+
+	applyAccidents();
+
+#if CELL_ORGANISM_USE_LINEAGE
+	PHASE_SCOPE("lineages");
+	lineageTick += 1;
+	phylogeny.prune();
+#endif
+}
+
+template <class CellType>
+void BasicGridWorld<CellType>::sweep()
 {
-	Position p;
+	Position p(mFirstRow, 0);
 	for (int blockRow = 0; blockRow < cellBlocks.rows(); ++blockRow) {
 		Restorer<int> colRestorer(p.col);
 		for (int blockCol = 0; blockCol < cellBlocks.columns(); ++blockCol) {
 			Restorer<int> rowRestorer(p.row);
-			Block<Cell>& block = cellBlocks.block(blockRow, blockCol);
+			Block<CellType>& block = cellBlocks.block(blockRow, blockCol);
+			PHASE_SCOPE("block");
 
 			int cellRow = 0;
 			if (cellRow < block.rows()) {
+				PHASE_SCOPE("peripheral");
 				Restorer<int> colRestorer(p.col);
 				for (int cellCol = 0; cellCol < block.columns(); ++cellCol) {
 					peripheralBlockUpdate(block, {cellRow, cellCol}, p);
@@ -91,24 +173,29 @@ void GridWorld::update()
 				}
 				p.row += 1;
 			}
-			for (cellRow = 1; cellRow < (block.rows()-1); ++cellRow) {
-				Restorer<int> colRestorer(p.col);
-				int cellCol = 0;
-				if (cellCol < block.columns()) {
-					peripheralBlockUpdate(block, {cellRow, cellCol}, p);
-					p.col += 1;
-				}
-				for (cellCol = 1; cellCol < (block.columns()-1); ++cellCol) {
-					innerBlockUpdate(block, {cellRow, cellCol}, p);
-					p.col += 1;
-				}
-				if (cellCol < block.columns()) {
-					peripheralBlockUpdate(block, {cellRow, cellCol}, p);
-					p.col += 1;
+			{
+				// NOTE: with the first and last cell of the rows
+				PHASE_SCOPE("inner");
+				for (cellRow = 1; cellRow < (block.rows()-1); ++cellRow) {
+					Restorer<int> colRestorer(p.col);
+					int cellCol = 0;
+					if (cellCol < block.columns()) {
+						peripheralBlockUpdate(block, {cellRow, cellCol}, p);
+						p.col += 1;
+					}
+					for (cellCol = 1; cellCol < (block.columns()-1); ++cellCol) {
+						innerBlockUpdate(block, {cellRow, cellCol}, p);
+						p.col += 1;
+					}
+					if (cellCol < block.columns()) {
+						peripheralBlockUpdate(block, {cellRow, cellCol}, p);
+						p.col += 1;
+					}
+					p.row += 1;
 				}
-				p.row += 1;
 			}
 			if (cellRow < block.rows()) {
+				PHASE_SCOPE("peripheral");
 				Restorer<int> colRestorer(p.col);
 				for (int cellCol = 0; cellCol < block.columns(); ++cellCol) {
 					peripheralBlockUpdate(block, {cellRow, cellCol}, p);
@@ -121,13 +208,12 @@ void GridWorld::update()
 		}
 		p.row += BLOCK_ROWS;
 	}
-
-	applyAccidents();
 }
 
-void GridWorld::peripheralBlockUpdate(Block<Cell> &block, Position localPosition, Position globalPosition)
+template <class CellType>
+void BasicGridWorld<CellType>::peripheralBlockUpdate(Block<CellType> &block, Position localPosition, Position globalPosition)
 {
-	Cell &cell = block.cell(localPosition);
+	CellType &cell = block.cell(localPosition);
 	if (cell.hasPlant()) {
 		peripheralBlockPlantUpdate(block, localPosition, globalPosition);
 	}
@@ -139,49 +225,58 @@ void GridWorld::peripheralBlockUpdate(Block<Cell> &block, Position localPosition
 	}
 }
 
-void GridWorld::topLeftWorldPeripheralBlockUpdate(Block<Cell> &block, Position localPosition, Position globalPosition)
+template <class CellType>
+void BasicGridWorld<CellType>::topLeftWorldPeripheralBlockUpdate(Block<CellType> &block, Position localPosition, Position globalPosition)
 {
 
 }
 
-void GridWorld::topWorldPeripheralBlockUpdate(Block<Cell> &block, Position localPosition, Position globalPosition)
+template <class CellType>
+void BasicGridWorld<CellType>::topWorldPeripheralBlockUpdate(Block<CellType> &block, Position localPosition, Position globalPosition)
 {
 
 }
 
-void GridWorld::topRightWorldPeripheralBlockUpdate(Block<Cell> &block, Position localPosition, Position globalPosition)
+template <class CellType>
+void BasicGridWorld<CellType>::topRightWorldPeripheralBlockUpdate(Block<CellType> &block, Position localPosition, Position globalPosition)
 {
 
 }
 
-void GridWorld::leftWorldPeripheralBlockUpdate(Block<Cell> &block, Position localPosition, Position globalPosition)
+template <class CellType>
+void BasicGridWorld<CellType>::leftWorldPeripheralBlockUpdate(Block<CellType> &block, Position localPosition, Position globalPosition)
 {
 
 }
 
-void GridWorld::rightWorldPeripheralBlockUpdate(Block<Cell> &block, Position localPosition, Position globalPosition)
+template <class CellType>
+void BasicGridWorld<CellType>::rightWorldPeripheralBlockUpdate(Block<CellType> &block, Position localPosition, Position globalPosition)
 {
 
 }
 
-void GridWorld::bottomLeftWorldPeripheralBlockUpdate(Block<Cell> &block, Position localPosition, Position globalPosition)
+template <class CellType>
+void BasicGridWorld<CellType>::bottomLeftWorldPeripheralBlockUpdate(Block<CellType> &block, Position localPosition, Position globalPosition)
 {
 
 }
 
-void GridWorld::bottomWorldPeripheralBlockUpdate(Block<Cell> &block, Position localPosition, Position globalPosition)
+template <class CellType>
+void BasicGridWorld<CellType>::bottomWorldPeripheralBlockUpdate(Block<CellType> &block, Position localPosition, Position globalPosition)
 {
 
 }
 
-void GridWorld::bottomRightWorldPeripheralBlockUpdate(Block<Cell> &block, Position localPosition, Position globalPosition)
+template <class CellType>
+void BasicGridWorld<CellType>::bottomRightWorldPeripheralBlockUpdate(Block<CellType> &block, Position localPosition, Position globalPosition)
 {
 
 }
 
-void GridWorld::innerBlockUpdate(Block<Cell> &block, Position localPosition, Position globalPosition)
+template <class CellType>
+void BasicGridWorld<CellType>::innerBlockUpdate(Block<CellType> &block, Position localPosition, Position globalPosition)
 {
-	Cell &cell = block.cell(localPosition);
+	CellType &cell = block.cell(localPosition);
 	if (cell.hasPlant()) {
 		innerBlockPlantUpdate(block, localPosition, globalPosition);
 	}
@@ -193,14 +288,15 @@ void GridWorld::innerBlockUpdate(Block<Cell> &block, Position localPosition, Pos
 	}
 }
 
-void GridWorld::peripheralBlockPlantUpdate(Block<Cell> &block, Position localPosition, Position globalPosition)
+template <class CellType>
+void BasicGridWorld<CellType>::peripheralBlockPlantUpdate(Block<CellType> &block, Position localPosition, Position globalPosition)
 {
-	Cell& cell = block.cell(localPosition);
+	CellType& cell = block.cell(localPosition);
 	Plant* plant = cell.plant();
 	Plant tmpPlant = *plant;
 	if (tmpPlant.energy >= tmpPlant.reproductionEnergy) {
 		Position nearbyGlobalPosition = randomNearbyWraparoundedPosition(globalPosition);
-		Cell &nearbyCell = cellBlocks.cell(nearbyGlobalPosition);
+		CellType &nearbyCell = cellAt(nearbyGlobalPosition);
 		if (!nearbyCell.hasPlant()) {
 			nearbyCell.setPlant(reproduce(tmpPlant));
 		}
@@ -211,20 +307,22 @@ void GridWorld::peripheralBlockPlantUpdate(Block<Cell> &block, Position localPos
 		tmpPlant.energy += 1;
 	}
 	if (tmpPlant.energy <= 0) {
+		died(tmpPlant);
 		cell.removePlant();
 	} else {
 		*plant = tmpPlant;
 	}
 }
 
-void GridWorld::innerBlockPlantUpdate(Block<Cell> &block, Position localPosition, Position globalPosition)
+template <class CellType>
+void BasicGridWorld<CellType>::innerBlockPlantUpdate(Block<CellType> &block, Position localPosition, Position globalPosition)
 {
-	Cell& cell = block.cell(localPosition);
+	CellType& cell = block.cell(localPosition);
 	Plant* plant = cell.plant();
 	Plant tmpPlant = *plant;
 	if (tmpPlant.energy >= tmpPlant.reproductionEnergy) {
 		Position nearbyLocalPosition = randomNearbyPosition(localPosition);
-		Cell &nearbyCell = block.cell(nearbyLocalPosition);
+		CellType &nearbyCell = block.cell(nearbyLocalPosition);
 		if (!nearbyCell.hasPlant()) {
 			nearbyCell.setPlant(reproduce(tmpPlant));
 		}
@@ -235,18 +333,20 @@ void GridWorld::innerBlockPlantUpdate(Block<Cell> &block, Position localPosition
 		tmpPlant.energy += 1;
 	}
 	if (tmpPlant.energy <= 0) {
+		died(tmpPlant);
 		cell.removePlant();
 	} else {
 		*plant = tmpPlant;
 	}
 }
 
-void GridWorld::peripheralBlockHerbivoreUpdate(Block<Cell> &block, Position localPosition, Position globalPosition)
+template <class CellType>
+void BasicGridWorld<CellType>::peripheralBlockHerbivoreUpdate(Block<CellType> &block, Position localPosition, Position globalPosition)
 {
-	Cell* cell = &block.cell(localPosition);
+	CellType* cell = &block.cell(localPosition);
 	Herbivore* herbivore = cell->herbivore();
 	Position nearbyGlobalPosition = randomNearbyWraparoundedPosition(globalPosition);
-	Cell* nearbyCell = &cellBlocks.cell(nearbyGlobalPosition);
+	CellType* nearbyCell = &cellAt(nearbyGlobalPosition);
 	if (herbivore->energy >= herbivore->reproductionEnergy) {
 		if (!nearbyCell->hasHerbivore() && !nearbyCell->hasCarnivore()) {
 			nearbyCell->setHerbivore(reproduce(*herbivore));
@@ -257,6 +357,7 @@ void GridWorld::peripheralBlockHerbivoreUpdate(Block<Cell> &block, Position loca
 			cell->removeHerbivore();
 			cell = nearbyCell;
 			herbivore = cell->herbivore();
+			moved(*herbivore);
 		}
 		if (cell->hasPlant()) {
 			Plant* plant = cell->plant();
@@ -264,22 +365,26 @@ void GridWorld::peripheralBlockHerbivoreUpdate(Block<Cell> &block, Position loca
 			herbivore->energy += (feast * 2/3);
 			plant->energy -= feast;
 			if (plant->energy == 0) {
+				preyed(*herbivore);
+				died(*plant);
 				cell->removePlant();
 			}
 		}
 	}
 	herbivore->energy -= 1;
 	if (herbivore->energy <= 0) {
+		died(*herbivore);
 		cell->removeHerbivore();
 	}
 }
 
-void GridWorld::innerBlockHerbivoreUpdate(Block<Cell> &block, Position localPosition, Position globalPosition)
+template <class CellType>
+void BasicGridWorld<CellType>::innerBlockHerbivoreUpdate(Block<CellType> &block, Position localPosition, Position globalPosition)
 {
-	Cell* cell = &block.cell(localPosition);
+	CellType* cell = &block.cell(localPosition);
 	Herbivore* herbivore = cell->herbivore();
 	Position nearbyLocalPosition = randomNearbyPosition(localPosition);
-	Cell* nearbyCell = &block.cell(nearbyLocalPosition);
+	CellType* nearbyCell = &block.cell(nearbyLocalPosition);
 	if (herbivore->energy >= herbivore->reproductionEnergy) {
 		if (!nearbyCell->hasHerbivore() && !nearbyCell->hasCarnivore()) {
 			nearbyCell->setHerbivore(reproduce(*herbivore));
@@ -290,6 +395,7 @@ void GridWorld::innerBlockHerbivoreUpdate(Block<Cell> &block, Position localPosi
 			cell->removeHerbivore();
 			cell = nearbyCell;
 			herbivore = cell->herbivore();
+			moved(*herbivore);
 		}
 		if (cell->hasPlant()) {
 			Plant* plant = cell->plant();
@@ -297,21 +403,25 @@ void GridWorld::innerBlockHerbivoreUpdate(Block<Cell> &block, Position localPosi
 			herbivore->energy += (feast * 2/3);
 			plant->energy -= feast;
 			if (plant->energy == 0) {
+				preyed(*herbivore);
+				died(*plant);
 				cell->removePlant();
 			}
 		}
 	}
 	herbivore->energy -= 1;
 	if (herbivore->energy <= 0) {
+		died(*herbivore);
 		cell->removeHerbivore();
 	}
 }
 
-void GridWorld::peripheralBlockCarnivoreUpdate(Block<Cell> &block, Position localPosition, Position globalPosition)
+template <class CellType>
+void BasicGridWorld<CellType>::peripheralBlockCarnivoreUpdate(Block<CellType> &block, Position localPosition, Position globalPosition)
 {
 	Carnivore* carnivore = block.cell(localPosition).carnivore();
 	Position nearbyGlobalPosition = randomNearbyWraparoundedPosition(globalPosition);
-	Cell* nearbyCell = &cellBlocks.cell(nearbyGlobalPosition);
+	CellType* nearbyCell = &cellAt(nearbyGlobalPosition);
 	if (carnivore->energy >= carnivore->reproductionEnergy) {
 		if (!nearbyCell->hasHerbivore() && !nearbyCell->hasCarnivore()) {
 			nearbyCell->setCarnivore(reproduce(*carnivore));
@@ -320,25 +430,30 @@ void GridWorld::peripheralBlockCarnivoreUpdate(Block<Cell> &block, Position loca
 		if (!nearbyCell->hasCarnivore()) {
 			if (nearbyCell->hasHerbivore()) {
 				carnivore->energy += (nearbyCell->herbivore()->energy * 2/3);
+				preyed(*carnivore);
+				died(*nearbyCell->herbivore());
 				nearbyCell->removeHerbivore();
 			}
 			nearbyCell->setCarnivore(*carnivore);
 			block.cell(localPosition).removeCarnivore();
 			carnivore = nearbyCell->carnivore();
+			moved(*carnivore);
 			globalPosition = nearbyGlobalPosition;
 		}
 	}
 	carnivore->energy -= 1;
 	if (carnivore->energy <= 0) {
-		cellBlocks.cell(globalPosition).removeCarnivore();
+		died(*carnivore);
+		cellAt(globalPosition).removeCarnivore();
 	}
 }
 
-void GridWorld::innerBlockCarnivoreUpdate(Block<Cell> &block, Position localPosition, Position globalPosition)
+template <class CellType>
+void BasicGridWorld<CellType>::innerBlockCarnivoreUpdate(Block<CellType> &block, Position localPosition, Position globalPosition)
 {
 	Carnivore* carnivore = block.cell(localPosition).carnivore();
 	Position nearbyLocalPosition = randomNearbyPosition(localPosition);
-	Cell* nearbyCell = &block.cell(nearbyLocalPosition);
+	CellType* nearbyCell = &block.cell(nearbyLocalPosition);
 	if (carnivore->energy >= carnivore->reproductionEnergy) {
 		if (!nearbyCell->hasHerbivore() && !nearbyCell->hasCarnivore()) {
 			nearbyCell->setCarnivore(reproduce(*carnivore));
@@ -347,43 +462,75 @@ void GridWorld::innerBlockCarnivoreUpdate(Block<Cell> &block, Position localPosi
 		if (!nearbyCell->hasCarnivore()) {
 			if (nearbyCell->hasHerbivore()) {
 				carnivore->energy += (nearbyCell->herbivore()->energy * 2/3);
+				preyed(*carnivore);
+				died(*nearbyCell->herbivore());
 				nearbyCell->removeHerbivore();
 			}
 			nearbyCell->setCarnivore(*carnivore);
 			block.cell(localPosition).removeCarnivore();
 			carnivore = nearbyCell->carnivore();
+			moved(*carnivore);
 			localPosition = nearbyLocalPosition;
 		}
 	}
 	carnivore->energy -= 1;
 	if (carnivore->energy <= 0) {
+		died(*carnivore);
 		block.cell(localPosition).removeCarnivore();
 	}
 }
 
-void GridWorld::clearAccidents()
+template <class CellType>
+void BasicGridWorld<CellType>::clearAccidents()
 {
 	/*for (auto position : lastAccidents) {
-		Cell& cell = cellBlocks.cell(position);
+		CellType& cell = cellBlocks.cell(position);
 		cell.accident() = false;
 	}*/
 	lastAccidents.clear();
 }
 
-void GridWorld::applyAccidents()
+template <class CellType>
+void BasicGridWorld<CellType>::applyAccidents()
 {
+	PHASE_SCOPE("accidents");
 	//clearAccidents();
-	for (int i = 0; i < 5; ++i) {
-		Position position = randomPosition();
-		Cell& cell = cellBlocks.cell(position);
-		//cell.accident() = true;
-		cell.removePlant();
-		cell.removeHerbivore();
+	for (Position position : drawAccidents()) {
+		applyAccident(position);
 		//lastAccidents.push_back(position);
 	}
 }
 
-Plant GridWorld::reproduce(Plant &parent)
+template <class CellType>
+std::vector<Position> BasicGridWorld<CellType>::drawAccidents()
+{
+	std::vector<Position> positions;
+	for (int i = 0; i < accidentCount; ++i) {
+		positions.push_back(randomPosition());
+	}
+	return positions;
+}
+
+template <class CellType>
+void BasicGridWorld<CellType>::applyAccident(Position position)
+{
+	if (!containsRow(position.row)) {
+		return;
+	}
+	CellType& cell = cellAt(position);
+	//cell.accident() = true;
+	if (cell.hasPlant()) {
+		died(*cell.plant());
+	}
+	if (cell.hasHerbivore()) {
+		died(*cell.herbivore());
+	}
+	cell.removePlant();
+	cell.removeHerbivore();
+}
+
+template <class CellType>
+Plant BasicGridWorld<CellType>::reproduce(Plant &parent)
 {
 	Plant child;
 	child.energy = parent.offspringEnergy;
@@ -395,10 +542,13 @@ Plant GridWorld::reproduce(Plant &parent)
 
 	parent.energy -= (parent.offspringEnergy * 1.5);
 
+	descended(child, parent);
+	born(child);
 	return child;
 }
 
-Herbivore GridWorld::reproduce(Herbivore &parent)
+template <class CellType>
+Herbivore BasicGridWorld<CellType>::reproduce(Herbivore &parent)
 {
 	Herbivore child;
 	child.energy = parent.offspringEnergy;
@@ -411,10 +561,13 @@ Herbivore GridWorld::reproduce(Herbivore &parent)
 
 	parent.energy -= (parent.offspringEnergy * 1.5);
 
+	descended(child, parent);
+	born(child);
 	return child;
 }
 
-Carnivore GridWorld::reproduce(Carnivore &parent)
+template <class CellType>
+Carnivore BasicGridWorld<CellType>::reproduce(Carnivore &parent)
 {
 	Carnivore child;
 	child.energy = parent.offspringEnergy;
@@ -426,23 +579,215 @@ Carnivore GridWorld::reproduce(Carnivore &parent)
 
 	parent.energy -= (parent.offspringEnergy * 1.5);
 
+	descended(child, parent);
+	born(child);
 	return child;
 }
 
-void GridWorld::render() const
+template <class CellType>
+void BasicGridWorld<CellType>::snapshot()
+{
+	PHASE_SCOPE("snapshot");
+#ifndef EVOLUTION_HEADLESS
+	renderer.snapshot(*this);
+#endif
+}
+
+// NOTE: organisms of a domain move to and from the halo rows, statistics are
+// only kept for a whole world
+template <class CellType>
+void BasicGridWorld<CellType>::analyze()
+{
+	if (mOwnedRowCount < rows) {
+		return;
+	}
+	PHASE_SCOPE("statistics");
+	if (!statisticsStarted) {
+		startStatistics();
+	}
+	statistics.collect();
+}
+
+template <class CellType>
+std::vector<std::string> BasicGridWorld<CellType>::telemetryColumns() const
+{
+	if (mOwnedRowCount < rows) {
+		return {};
+	}
+	return GridWorldTelemetry::columns();
+}
+
+// NOTE: the quantiles of every tick are read off the statistics, recording
+// telemetry starts them like analyze() does
+template <class CellType>
+void BasicGridWorld<CellType>::telemetry(std::int32_t* values)
+{
+	if (mOwnedRowCount < rows) {
+		return;
+	}
+	if (!statisticsStarted) {
+		startStatistics();
+	}
+	mTelemetry.record(*this, values);
+}
+
+template <class CellType>
+bool BasicGridWorld<CellType>::writePhylogeny(std::ostream& out)
+{
+#if CELL_ORGANISM_USE_LINEAGE
+	if (mOwnedRowCount < rows) {
+		std::cout << "A domain of a decomposed world does not track lineages" << std::endl;
+		return false;
+	}
+	phylogeny.flush();
+	phylogeny.write(out);
+	return true;
+#else
+	(void)out;
+#endif
+	return false;
+}
+
+// the organisms alive so far, later ones are added as they are born
+template <class CellType>
+void BasicGridWorld<CellType>::startStatistics()
+{
+	for (int r = 0; r < cellBlocks.rows(); ++r) {
+		for (int c = 0; c < cellBlocks.columns(); ++c) {
+			const Block<CellType>& block = cellBlocks.block(r, c);
+			for (int i = 0; i < block.rows(); ++i) {
+				for (int j = 0; j < block.columns(); ++j) {
+					const CellType& cell = block.cell(i, j);
+					if (cell.hasPlant()) {
+						statistics.add(*cell.plant());
+					}
+					if (cell.hasHerbivore()) {
+						statistics.add(*cell.herbivore());
+					}
+					if (cell.hasCarnivore()) {
+						statistics.add(*cell.carnivore());
+					}
+				}
+			}
+		}
+	}
+	statisticsStarted = true;
+}
+
+template <class CellType>
+void BasicGridWorld<CellType>::render() const
+{
+#ifndef EVOLUTION_HEADLESS
+	renderer.render();
+#endif
+}
+
+// NOTE: colors of the renderer, a domain only draws its own rows
+template <class CellType>
+bool BasicGridWorld<CellType>::rasterize(Frame& frame) const
 {
-	renderer.render(*this);
+	frame.resize(mOwnedRowCount, columns);
+
+	#pragma omp parallel for collapse(2) schedule(dynamic)
+	for (int r = 0; r < cellBlocks.rows(); ++r) {
+		for (int c = 0; c < cellBlocks.columns(); ++c) {
+			const Block<CellType>& block = cellBlocks.block(r, c);
+			for (int i = 0; i < block.rows(); ++i) {
+				int row = r * BLOCK_ROWS + i;
+				for (int j = 0; j < block.columns(); ++j) {
+					const CellType &cell = block.cell(i, j);
+					int column = c * BLOCK_COLUMNS + j;
+					std::uint8_t plant = cell.hasPlant() ? 25 : 0;
+					if (cell.hasCarnivore()) {
+						frame.setPixel(row, column, 255, plant, 0);
+					} else if (cell.hasHerbivore()) {
+						frame.setPixel(row, column, 0, plant, 255);
+					} else if (cell.hasPlant()) {
+						frame.setPixel(row, column, 0, 255, 0);
+					} else {
+						frame.setPixel(row, column, 0, 0, 0);
+					}
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
+template <class CellType>
+void BasicGridWorld<CellType>::setViewport(const Viewport& viewport)
+{
+#ifndef EVOLUTION_HEADLESS
+	renderer.setViewport(viewport, rows, columns);
+#endif
+}
+
+template <class CellType>
+int BasicGridWorld<CellType>::cellCount() const
+{
+	return rows * columns;
+}
+
+template <class CellType>
+void BasicGridWorld<CellType>::setSeed(unsigned seed)
+{
+	random.seed(seed);
+}
+
+template <class CellType>
+void BasicGridWorld<CellType>::setAccidentCount(int count)
+{
+	accidentCount = count;
+}
+
+// NOTE: organisms move to and from the halo rows of a domain without being
+// born or dying, only whole worlds count them by their births and deaths
+template <class CellType>
+int BasicGridWorld<CellType>::organismCount() const
+{
+	if (mOwnedRowCount == rows) {
+		return mTelemetry.organismCount();
+	}
+	Population count = population();
+	return count.plants + count.herbivores + count.carnivores;
+}
+
+template <class CellType>
+typename BasicGridWorld<CellType>::Population BasicGridWorld<CellType>::population() const
+{
+	if (statisticsStarted) {
+		return {statistics.plantCount(), statistics.herbivoreCount(), statistics.carnivoreCount()};
+	}
+
+	Population result = {0, 0, 0};
+	for (int r = 0; r < cellBlocks.rows(); ++r) {
+		for (int c = 0; c < cellBlocks.columns(); ++c) {
+			const Block<CellType>& block = cellBlocks.block(r, c);
+			for (int i = 0; i < block.rows(); ++i) {
+				for (int j = 0; j < block.columns(); ++j) {
+					const CellType& cell = block.cell(i, j);
+					result.plants += cell.hasPlant();
+					result.herbivores += cell.hasHerbivore();
+					result.carnivores += cell.hasCarnivore();
+				}
+			}
+		}
+	}
+	return result;
 }
 
-Position GridWorld::randomPosition()
+template <class CellType>
+Position BasicGridWorld<CellType>::randomPosition()
 {
 	return {
-		xPositionDistribution(random),
-		yPositionDistribution(random)
+		yPositionDistribution(random),
+		xPositionDistribution(random)
 	};
 }
 
-Position GridWorld::randomNearbyPosition(Position position)
+template <class CellType>
+Position BasicGridWorld<CellType>::randomNearbyPosition(Position position)
 {
 	const Position offsets[] = {
 		{-1, -1}, {-1, 0}, {-1, 1},
@@ -455,12 +800,135 @@ Position GridWorld::randomNearbyPosition(Position position)
 	return position;
 }
 
-Position GridWorld::randomNearbyWraparoundedPosition(Position position)
+template <class CellType>
+Position BasicGridWorld<CellType>::randomNearbyWraparoundedPosition(Position position)
 {
 	return wraparound(randomNearbyPosition(position));
 }
 
-Position GridWorld::wraparound(Position position)
+// Rows outside the domain must be one of the halo rows.
+template <class CellType>
+CellType& BasicGridWorld<CellType>::cellAt(Position position)
+{
+	int row = position.row - mFirstRow;
+	if (row >= 0 && row < mOwnedRowCount) {
+		return cellBlocks.cell(row, position.col);
+	}
+	return haloAt(position.row)[position.col];
+}
+
+template <class CellType>
+std::vector<CellType>& BasicGridWorld<CellType>::haloAt(int row)
+{
+	return const_cast<std::vector<CellType>&>(static_cast<const BasicGridWorld*>(this)->haloAt(row));
+}
+
+template <class CellType>
+const std::vector<CellType>& BasicGridWorld<CellType>::haloAt(int row) const
+{
+	if (row == (mFirstRow + rows - 1) % rows) {
+		return haloAbove;
+	}
+	assert(row == (mFirstRow + mOwnedRowCount) % rows);
+	return haloBelow;
+}
+
+template <class CellType>
+bool BasicGridWorld<CellType>::containsRow(int row) const
+{
+	if (row >= mFirstRow && row < (mFirstRow + mOwnedRowCount)) {
+		return true;
+	}
+	return mOwnedRowCount < rows
+		&& (row == (mFirstRow + rows - 1) % rows || row == (mFirstRow + mOwnedRowCount) % rows);
+}
+
+template <class CellType>
+void BasicGridWorld<CellType>::copyRow(int row, CellType* cells) const
+{
+	assert(containsRow(row));
+	if (row >= mFirstRow && row < (mFirstRow + mOwnedRowCount)) {
+		for (int c = 0; c < columns; ++c) {
+			cells[c] = cellBlocks.cell(row - mFirstRow, c);
+		}
+	} else {
+		std::copy(haloAt(row).begin(), haloAt(row).end(), cells);
+	}
+}
+
+template <class CellType>
+void BasicGridWorld<CellType>::setRow(int row, const CellType* cells)
+{
+	assert(containsRow(row));
+	if (row >= mFirstRow && row < (mFirstRow + mOwnedRowCount)) {
+		for (int c = 0; c < columns; ++c) {
+			cellBlocks.cell(row - mFirstRow, c) = cells[c];
+		}
+	} else {
+		std::copy(cells, cells + columns, haloAt(row).begin());
+	}
+}
+
+// NOTE: seeding with the state restores it, minstd states are in [1, m)
+template <class CellType>
+unsigned BasicGridWorld<CellType>::randomState() const
+{
+	std::stringstream stream;
+	stream << random;
+	unsigned state;
+	stream >> state;
+	return state;
+}
+
+namespace {
+
+inline void hashCombine(std::uint64_t& hash, std::uint64_t value)
+{
+	hash ^= value + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+}
+
+inline void hashOrganism(std::uint64_t& hash, const Organism& organism)
+{
+	hashCombine(hash, organism.energy);
+	hashCombine(hash, organism.reproductionEnergy);
+	hashCombine(hash, organism.offspringEnergy);
+	hashCombine(hash, organism.geneDecrementFactor);
+	hashCombine(hash, organism.geneStabilizeFactor);
+	hashCombine(hash, organism.geneIncrementFactor);
+}
+
+} // namespace
+
+template <class CellType>
+std::uint64_t BasicGridWorld<CellType>::digest() const
+{
+	std::uint64_t sum = 0;
+	for (int r = 0; r < mOwnedRowCount; ++r) {
+		std::uint64_t hash = mFirstRow + r;
+		for (int c = 0; c < columns; ++c) {
+			const CellType& cell = cellBlocks.cell(r, c);
+			hashCombine(hash, c);
+			if (cell.hasPlant()) {
+				hashCombine(hash, 1);
+				hashOrganism(hash, *cell.plant());
+			}
+			if (cell.hasHerbivore()) {
+				hashCombine(hash, 2);
+				hashOrganism(hash, *cell.herbivore());
+				hashCombine(hash, cell.herbivore()->feastSize);
+			}
+			if (cell.hasCarnivore()) {
+				hashCombine(hash, 3);
+				hashOrganism(hash, *cell.carnivore());
+			}
+		}
+		sum += hash;
+	}
+	return sum;
+}
+
+template <class CellType>
+Position BasicGridWorld<CellType>::wraparound(Position position)
 {
 	while (position.row < 0) {
 		position.row += rows;
@@ -477,7 +945,8 @@ Position GridWorld::wraparound(Position position)
 	return position;
 }
 
-int GridWorld::randomOffset(int decrementFactor, int stabilizeFactor, int incrementFactor) const
+template <class CellType>
+int BasicGridWorld<CellType>::randomOffset(int decrementFactor, int stabilizeFactor, int incrementFactor) const
 {
 	ModuloIntDistribution<int> dist(0, decrementFactor + stabilizeFactor + incrementFactor - 1);
 	int n = dist(random);
@@ -489,3 +958,16 @@ int GridWorld::randomOffset(int decrementFactor, int stabilizeFactor, int increm
 		return 1;
 	}
 }
+
+// NOTE: with GRIDWORLD_CELL_VARIANTS every cell layout is built, for comparing
+// them in one binary
+#ifdef GRIDWORLD_CELL_VARIANTS
+template class BasicGridWorld<InlineCell>;
+template class BasicGridWorld<HeapCell>;
+template class BasicGridWorld<RetainedCell>;
+template class BasicGridWorld<PimplInlineCell>;
+template class BasicGridWorld<PimplHeapCell>;
+template class BasicGridWorld<PimplRetainedCell>;
+#else
+template class BasicGridWorld<Cell>;
+#endif
@@ -1,29 +1,140 @@
 #ifndef GRIDWORLD_H
 #define GRIDWORLD_H
 
+#include "Cell.h"
+#include "GridWorldStatistics.h"
+#include "GridWorldTelemetry.h"
+#include "Phylogeny.h"
+#ifndef EVOLUTION_HEADLESS
 #include "GridWorldRenderer.h"
+#endif
 
 #include "../BlockMap.h"
 #include "../ModuloIntDistribution.h"
 #include "../Position.h"
 #include "../Simulation.h"
 
+#include <cstdint>
 #include <vector>
 #include <set>
 #include <random>
 #include <algorithm>
 
-class GridWorld final : public Simulation
+// The world over cells of the given layout. GridWorld is built with the
+// layout selected in Cell.h, the other layouts are only built into
+// evolution-bench, see GRIDWORLD_CELL_VARIANTS.
+template <class CellType>
+class BasicGridWorld final : public Simulation
 {
 public:
-	GridWorld();
+	struct Population
+	{
+		int plants;
+		int herbivores;
+		int carnivores;
+	};
+
+	BasicGridWorld();
+
+	BasicGridWorld(int rows, int columns);
+
+	// herbivores and carnivores are 2/5 and 1/5 of the plants
+	BasicGridWorld(int rows, int columns, int plantCount);
+
+	// Domain of a decomposed world: only the given block rows are stored,
+	// plus a copy of the row above and below them.
+	BasicGridWorld(int rows, int columns, int plantCount, int firstBlockRow, int blockRowCount);
 
 	virtual bool initialize() override;
 
 	virtual void update() override;
 
+	virtual void snapshot() override;
+
+	virtual void analyze() override;
+
+	virtual std::vector<std::string> telemetryColumns() const override;
+
+	virtual void telemetry(std::int32_t* values) override;
+
+	virtual bool writePhylogeny(std::ostream& out) override;
+
 	virtual void render() const override;
 
+	virtual bool rasterize(Frame& frame) const override;
+
+	virtual void setViewport(const Viewport& viewport) override;
+
+	virtual int cellCount() const override;
+
+	virtual int organismCount() const override;
+
+	void setSeed(unsigned seed);
+
+	// 2500 plants per 128x128 cells, at most one a cell
+	static int defaultPlantCount(int rows, int columns)
+	{
+		std::int64_t cells = std::int64_t(rows) * columns;
+		return int(std::min(cells, std::int64_t(2500) * cells / (128 * 128)));
+	}
+
+	// cells cleared by accidents every tick
+	void setAccidentCount(int count);
+
+	Population population() const;
+
+	// domain decomposition
+
+	static int blockRowHeight()
+	{
+		return BLOCK_ROWS;
+	}
+
+	static int blockRowCount(int rows)
+	{
+		return (rows + BLOCK_ROWS - 1) / BLOCK_ROWS;
+	}
+
+	int firstRow() const
+	{
+		return mFirstRow;
+	}
+
+	int ownedRowCount() const
+	{
+		return mOwnedRowCount;
+	}
+
+	int rowCount() const
+	{
+		return rows;
+	}
+
+	int columnCount() const
+	{
+		return columns;
+	}
+
+	// owned rows and the halo rows
+	bool containsRow(int row) const;
+
+	void copyRow(int row, CellType* cells) const;
+
+	void setRow(int row, const CellType* cells);
+
+	// update() without the accidents
+	void sweep();
+
+	std::vector<Position> drawAccidents();
+
+	void applyAccident(Position position);
+
+	unsigned randomState() const;
+
+	// order independent hash of the owned rows, summed over domains it gives
+	// the hash of the whole world
+	std::uint64_t digest() const;
+
 private:
 
 	void clearAccidents();
@@ -31,39 +142,39 @@ private:
 	void applyAccidents();
 
 
-	void peripheralBlockUpdate(Block<Cell> &block, Position localPosition, Position globalPosition);
+	void peripheralBlockUpdate(Block<CellType> &block, Position localPosition, Position globalPosition);
 
-	void topLeftWorldPeripheralBlockUpdate(Block<Cell> &block, Position localPosition, Position globalPosition);
+	void topLeftWorldPeripheralBlockUpdate(Block<CellType> &block, Position localPosition, Position globalPosition);
 
-	void topWorldPeripheralBlockUpdate(Block<Cell> &block, Position localPosition, Position globalPosition);
+	void topWorldPeripheralBlockUpdate(Block<CellType> &block, Position localPosition, Position globalPosition);
 
-	void topRightWorldPeripheralBlockUpdate(Block<Cell> &block, Position localPosition, Position globalPosition);
+	void topRightWorldPeripheralBlockUpdate(Block<CellType> &block, Position localPosition, Position globalPosition);
 
-	void leftWorldPeripheralBlockUpdate(Block<Cell> &block, Position localPosition, Position globalPosition);
+	void leftWorldPeripheralBlockUpdate(Block<CellType> &block, Position localPosition, Position globalPosition);
 
-	void rightWorldPeripheralBlockUpdate(Block<Cell> &block, Position localPosition, Position globalPosition);
+	void rightWorldPeripheralBlockUpdate(Block<CellType> &block, Position localPosition, Position globalPosition);
 
-	void bottomLeftWorldPeripheralBlockUpdate(Block<Cell> &block, Position localPosition, Position globalPosition);
+	void bottomLeftWorldPeripheralBlockUpdate(Block<CellType> &block, Position localPosition, Position globalPosition);
 
-	void bottomWorldPeripheralBlockUpdate(Block<Cell> &block, Position localPosition, Position globalPosition);
+	void bottomWorldPeripheralBlockUpdate(Block<CellType> &block, Position localPosition, Position globalPosition);
 
-	void bottomRightWorldPeripheralBlockUpdate(Block<Cell> &block, Position localPosition, Position globalPosition);
+	void bottomRightWorldPeripheralBlockUpdate(Block<CellType> &block, Position localPosition, Position globalPosition);
 
-	void innerBlockUpdate(Block<Cell> &block, Position localPosition, Position globalPosition);
+	void innerBlockUpdate(Block<CellType> &block, Position localPosition, Position globalPosition);
 
 
-	void peripheralBlockPlantUpdate(Block<Cell> &block, Position localPosition, Position globalPosition);
+	void peripheralBlockPlantUpdate(Block<CellType> &block, Position localPosition, Position globalPosition);
 
-	void peripheralBlockHerbivoreUpdate(Block<Cell> &block, Position localPosition, Position globalPosition);
+	void peripheralBlockHerbivoreUpdate(Block<CellType> &block, Position localPosition, Position globalPosition);
 
-	void peripheralBlockCarnivoreUpdate(Block<Cell> &block, Position localPosition, Position globalPosition);
+	void peripheralBlockCarnivoreUpdate(Block<CellType> &block, Position localPosition, Position globalPosition);
 
 
-	void innerBlockPlantUpdate(Block<Cell> &block, Position localPosition, Position globalPosition);
+	void innerBlockPlantUpdate(Block<CellType> &block, Position localPosition, Position globalPosition);
 
-	void innerBlockHerbivoreUpdate(Block<Cell> &block, Position localPosition, Position globalPosition);
+	void innerBlockHerbivoreUpdate(Block<CellType> &block, Position localPosition, Position globalPosition);
 
-	void innerBlockCarnivoreUpdate(Block<Cell> &block, Position localPosition, Position globalPosition);
+	void innerBlockCarnivoreUpdate(Block<CellType> &block, Position localPosition, Position globalPosition);
 
 
 	Plant reproduce(Plant &parent);
@@ -81,6 +192,12 @@ private:
 
 	Position wraparound(Position position);
 
+	CellType& cellAt(Position position);
+
+	std::vector<CellType>& haloAt(int row);
+
+	const std::vector<CellType>& haloAt(int row) const;
+
 	template <class T>
 	int randomOffset(const T& o) const
 	{
@@ -94,16 +211,139 @@ private:
 		return randomOffset(1, 1, 1);
 	}
 
+	void startStatistics();
+
+	template <class T>
+	void born(const T& organism)
+	{
+		mTelemetry.born(organism);
+		if (statisticsStarted) {
+			statistics.add(organism);
+		}
+	}
+
+	template <class T>
+	void died(const T& organism)
+	{
+		mTelemetry.died(organism);
+		if (statisticsStarted) {
+			statistics.remove(organism);
+		}
+		ended(organism);
+	}
+
+	// NOTE: only whole worlds have lineages, organisms of domains move
+	// between processes
+	template <class T>
+	void founded(T& organism)
+	{
+#if CELL_ORGANISM_USE_LINEAGE
+		organism.lineage = mOwnedRowCount < rows ? Phylogeny::NONE
+			: phylogeny.found(lineageSpecies(organism), lineageTick, organism.geneIncrementFactor, lineageFeastSize(organism));
+#else
+		(void)organism;
+#endif
+	}
+
+	template <class T>
+	void descended(T& child, const T& parent)
+	{
+#if CELL_ORGANISM_USE_LINEAGE
+		child.lineage = parent.lineage == Phylogeny::NONE ? Phylogeny::NONE
+			: phylogeny.descend(parent.lineage, lineageTick, child.geneIncrementFactor, lineageFeastSize(child));
+#else
+		(void)child;
+		(void)parent;
+#endif
+	}
+
+	template <class T>
+	void ended(const T& organism)
+	{
+#if CELL_ORGANISM_USE_LINEAGE
+		if (organism.lineage != Phylogeny::NONE) {
+			phylogeny.died(organism.lineage);
+		}
+#else
+		(void)organism;
+#endif
+	}
+
+#if CELL_ORGANISM_USE_LINEAGE && !CELL_PLANT_USE_LINEAGE
+	void founded(Plant& /*plant*/)
+	{
+	}
+
+	void descended(Plant& /*child*/, const Plant& /*parent*/)
+	{
+	}
+
+	void ended(const Plant& /*plant*/)
+	{
+	}
+#endif
+
+#if CELL_ORGANISM_USE_LINEAGE
+	static Phylogeny::Species lineageSpecies(const Plant& /*plant*/)
+	{
+		return Phylogeny::Plants;
+	}
+
+	static Phylogeny::Species lineageSpecies(const Herbivore& /*herbivore*/)
+	{
+		return Phylogeny::Herbivores;
+	}
+
+	static Phylogeny::Species lineageSpecies(const Carnivore& /*carnivore*/)
+	{
+		return Phylogeny::Carnivores;
+	}
+
+	static int lineageFeastSize(const Organism& /*organism*/)
+	{
+		return -1;
+	}
+
+	static int lineageFeastSize(const Herbivore& herbivore)
+	{
+		return herbivore.feastSize;
+	}
+#endif
+
+	template <class T>
+	void moved(const T& organism)
+	{
+		mTelemetry.moved(organism);
+	}
+
+	// the prey dies separately
+	template <class T>
+	void preyed(const T& predator)
+	{
+		mTelemetry.preyed(predator);
+	}
+
 private:
 	mutable std::minstd_rand0 random; // NOTE: fastest from std
 
 	int rows;
 	int columns;
 
+	int plantCount;
+	int herbivoreCount;
+	int carnivoreCount;
+
+	int accidentCount;
+
+	int mFirstRow;
+	int mOwnedRowCount;
+	std::vector<CellType> haloAbove;
+	std::vector<CellType> haloBelow;
+
 	static constexpr int BLOCK_ROWS = 128;
 	static constexpr int BLOCK_COLUMNS = 128;
 
-	BlockMap<Cell, BLOCK_ROWS, BLOCK_COLUMNS> cellBlocks;
+	BlockMap<CellType, BLOCK_ROWS, BLOCK_COLUMNS> cellBlocks;
 
 	std::vector<Position> lastAccidents;
 
@@ -112,9 +352,30 @@ private:
 	ModuloIntDistribution<> positionOffsetDistribution;
 	ModuloIntDistribution<> geneOffsetDistribution;
 
+	friend class DensityPyramid;
+
+	// kept from the first analyze() or telemetry() on, worlds that are neither
+	// analyzed nor recorded do
+	// not pay for them
+	bool statisticsStarted;
+	GridWorldStatistics statistics;
+
+	// NOTE: events are always counted, they are too cheap to switch
+	friend class GridWorldTelemetry;
+	GridWorldTelemetry mTelemetry;
+
+#if CELL_ORGANISM_USE_LINEAGE
+	std::uint32_t lineageTick;
+	Phylogeny phylogeny;
+#endif
+
+#ifndef EVOLUTION_HEADLESS
 	friend class GridWorldRenderer;
 
 	GridWorldRenderer renderer;
+#endif
 };
 
+typedef BasicGridWorld<Cell> GridWorld;
+
 #endif // GRIDWORLD_H
@@ -5,12 +5,16 @@
 #include "../Position.h"
 #include "../Restorer.h"
 
+#include <algorithm>
 #include <cstddef>
+#include <numeric>
 
 #include <iostream>
-#include <iomanip>
 
 GridWorldRenderer::GridWorldRenderer()
+#if GRIDWORLD_RENDER_USE_TEXTURE
+	: level(0)
+#endif
 {
 }
 
@@ -18,8 +22,20 @@ void GridWorldRenderer::initialize()
 {
 	initializeShaders();
 
-	instanceVertexBufferObject = VertexBufferObject::generate();
+#if GRIDWORLD_RENDER_USE_TEXTURE
+	cellTexture = Texture::generate();
 
+	// the area the instances cover
+	GLfloat quadVertices[] = {
+		-0.955f,  0.955f,
+		0.955f, -0.955f,
+		-0.955f, -0.955f,
+
+		-0.955f,  0.955f,
+		0.955f, -0.955f,
+		0.955f,  0.955f,
+	};
+#else
 	GLfloat quadVertices[] = {
 		-0.005f,  0.005f,
 		0.005f, -0.005f,
@@ -29,6 +45,7 @@ void GridWorldRenderer::initialize()
 		0.005f, -0.005f,
 		0.005f,  0.005f,
 	};
+#endif
 
 	quadVertexArrayObject = VertexArrayObject::generate();
 	quadVertexBufferObject = VertexBufferObject::generate();
@@ -38,166 +55,297 @@ void GridWorldRenderer::initialize()
 	glEnableVertexAttribArray(0);
 	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(GLfloat), (GLvoid*)0);
 
-	instanceVertexBufferObject.bind();
-	glEnableVertexAttribArray(1);
-	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Quad), (GLvoid*)offsetof(Quad, position));
-	glVertexAttribDivisor(1, 1);
-	glEnableVertexAttribArray(2);
-	glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Quad), (GLvoid*)offsetof(Quad, color));
-	glVertexAttribDivisor(2, 1);
-	instanceVertexBufferObject.unbind();
-
 	quadVertexArrayObject.unbind();
 }
 
+#if GRIDWORLD_RENDER_USE_TEXTURE
+
+// NOTE: column 0 is on the right and row 0 on the top, and animals cover
+// plants, like the instances. The visible part of the world wraps around.
 void GridWorldRenderer::initializeShaders()
 {
 	VertexShader vertexShader(
 		"#version 330 core\n"
 		"layout (location = 0) in vec2 position;\n"
-		"layout (location = 1) in vec2 offset;\n"
-		"layout (location = 2) in vec3 color;\n"
-		"out vec3 fColor;\n"
+		"out vec2 fPosition;\n"
 		"void main()\n"
 		"{\n"
-		"	gl_Position = vec4(position + offset, 0.0f, 1.0f);\n"
-		"	fColor = color;\n"
+		"	gl_Position = vec4(position, 0.0f, 1.0f);\n"
+		"	fPosition = position;\n"
 		"}\n"
 	);
 	FragmentShader fragmentShader(
 		"#version 330 core\n"
-		"in vec3 fColor;\n"
+		"uniform sampler2D cells;\n"
+		"uniform vec3 viewport;\n"
+		"uniform vec2 worldSize;\n"
+		"uniform float tileSize;\n"
+		"in vec2 fPosition;\n"
 		"out vec4 color;\n"
 		"void main()\n"
 		"{\n"
-		"	color = vec4(fColor, 1.0f);\n"
+		"	vec2 visible = (0.955f - fPosition) / 1.91f;\n"
+		"	vec2 world = fract(viewport.xy + (visible - 0.5f) / viewport.z);\n"
+		"	ivec2 size = textureSize(cells, 0);\n"
+		"	ivec2 cell = min(ivec2(world * worldSize / tileSize), size - 1);\n"
+		"	vec4 species = texelFetch(cells, cell, 0);\n"
+		"	float plant = species.r > 0.0f ? 0.1f : 0.0f;\n"
+		"	if (tileSize > 1.0f) {\n"
+		"		color = vec4(vec3(species.b, species.r, species.g) * (0.5f + 0.5f * species.a), 1.0f);\n"
+		"	} else if (species.b > 0.0f) {\n"
+		"		color = vec4(1.0f, plant, 0.0f, 1.0f);\n"
+		"	} else if (species.g > 0.0f) {\n"
+		"		color = vec4(0.0f, plant, 1.0f, 1.0f);\n"
+		"	} else if (species.r > 0.0f) {\n"
+		"		color = vec4(0.0f, 1.0f, 0.0f, 1.0f);\n"
+		"	} else {\n"
+		"		color = vec4(0.0f, 0.0f, 0.0f, 1.0f);\n"
+		"	}\n"
 		"}\n"
 	);
 
 	program = ShaderProgram(vertexShader, fragmentShader);
+	viewportLocation = program.uniformLocation("viewport");
+	worldSizeLocation = program.uniformLocation("worldSize");
+	tileSizeLocation = program.uniformLocation("tileSize");
 }
 
-void GridWorldRenderer::render(const GridWorld& gridWorld) const
+void GridWorldRenderer::setViewport(const Viewport& viewport, int rows, int columns)
 {
-	using namespace std;
+	this->viewport = viewport;
+	level = viewport.level(rows, columns);
+}
+
+// Zoomed out a texel is a tile of cells from the density pyramid, so the
+// texture is never much larger than the screen.
+void GridWorldRenderer::snapshot(const GridWorld& gridWorld)
+{
+	if (!snapshots.isConsumed()) {
+		return;
+	}
+
+	Snapshot& snapshot = snapshots.back();
+	snapshot.level = level;
+	snapshot.rows = gridWorld.rows;
+	snapshot.columns = gridWorld.columns;
+	if (snapshot.level == 0) {
+		setCellTexels(gridWorld);
+	} else {
+		setTileTexels(gridWorld, snapshot.level);
+	}
 
-	quads.clear();
-	plantStatistics.clear();
-	herbivoreStatistics.clear();
-	carnivoreStatistics.clear();
+	image.pack(snapshot.texels);
+	snapshots.publish();
+}
 
+void GridWorldRenderer::setCellTexels(const GridWorld& gridWorld)
+{
 	int rows = gridWorld.rows;
 	int columns = gridWorld.columns;
+	image.resize(rows, columns);
+
 	const BlockMap<Cell, GridWorld::BLOCK_ROWS, GridWorld::BLOCK_COLUMNS>& cellBlocks = gridWorld.cellBlocks;
-	Position p;
+	// NOTE: blocks write disjoint texels
+	#pragma omp parallel for collapse(2) schedule(dynamic)
 	for (int r = 0; r < cellBlocks.rows(); ++r) {
-		Restorer<int> colRestorer(p.col);
 		for (int c = 0; c < cellBlocks.columns(); ++c) {
 			const Block<Cell>& block = cellBlocks.block(r, c);
-			//std::uniform_real_distribution<float> cd(0.0f, 1.0f);
-			//glm::vec3 color(cd(mt), cd(mt), cd(mt));
-			Restorer<int> rowRestorer(p.row);
 			for (int i = 0; i < block.rows(); ++i) {
-				Restorer<int> colRestorer(p.col);
+				Texel* texels = image.texels() + (r * GridWorld::BLOCK_ROWS + i) * columns + c * GridWorld::BLOCK_COLUMNS;
 				for (int j = 0; j < block.columns(); ++j) {
 					const Cell &cell = block.cell(i, j);
-					GLfloat qx = 0.95f - GLfloat(1.90 * p.col) / columns;
-					GLfloat qy = 0.95f - GLfloat(1.90 * p.row) / rows;
-					if (cell.hasPlant()) {
-						quads.push_back({{qx, qy}, {0.0f, 1.0f, 0.0f}});
-						//quads.push_back({{qx, qy}, color});
-						plantStatistics.record(*cell.plant());
-
-						if (cell.hasHerbivore()) {
-							quads.push_back({{qx, qy}, {0.0f, 0.1f, 1.0f}});
-							herbivoreStatistics.record(*cell.herbivore());
-						}
-						if (cell.hasCarnivore()) {
-							quads.push_back({{qx, qy}, {1.0f, 0.1f, 0.0f}});
-							carnivoreStatistics.record(*cell.carnivore());
-						}
-					} else {
-						if (cell.hasHerbivore()) {
-							quads.push_back({{qx, qy}, {0.0f, 0.0f, 1.0f}});
-							herbivoreStatistics.record(*cell.herbivore());
-						}
-						if (cell.hasCarnivore()) {
-							quads.push_back({{qx, qy}, {1.0f, 0.0f, 0.0f}});
-							carnivoreStatistics.record(*cell.carnivore());
-						}
-					}
-					/*if (cell.accident()) {
-						quads.push_back({{qx, qy}, {1.0f, 1.0f, 0.0f}});
-					}*/
-					p.col += 1;
+					texels[j] = {
+						std::uint8_t(cell.hasPlant() ? 255 : 0),
+						std::uint8_t(cell.hasHerbivore() ? 255 : 0),
+						std::uint8_t(cell.hasCarnivore() ? 255 : 0),
+						0
+					};
 				}
-				p.row += 1;
 			}
-			p.col += block.columns();
 		}
-		p.row += GridWorld::BLOCK_ROWS;
 	}
+}
+
+// NOTE: mean energies of 100 and more are the brightest, the most the first
+// organisms start with
+void GridWorldRenderer::setTileTexels(const GridWorld& gridWorld, int level)
+{
+	pyramid.build(gridWorld, level);
+	int rows = pyramid.rows();
+	int columns = pyramid.columns();
+	image.resize(rows, columns);
 
-	cout << endl;
-	cout << "      plant herbi carni" << endl;
-	cout << "count" << setw(6)<<right << plantStatistics.energies.size() << setw(6)<<right << herbivoreStatistics.energies.size() << setw(6)<<right << carnivoreStatistics.energies.size() << endl;
-	cout << "energ" << setw(6)<<right << plantEnergy() << setw(6)<<right << herbivoreEnergy() << setw(6)<<right << carnivoreEnergy() << endl;
-	cout << "repro" << setw(6)<<right << plantReproduction() << setw(6)<<right << herbivoreReproduction() << setw(6)<<right << carnivoreReproduction() <<  std::endl;
-	cout << "offsp" << setw(6)<<right << plantOffspring() << setw(6)<<right << herbivoreOffspring() << setw(6)<<right << carnivoreOffspring() << std::endl;
-	cout << "decre" << setw(6)<<right << plantGeneDecrementFactor() << setw(6)<<right << herbivoreGeneDecrementFactor() << setw(6)<<right << carnivoreGeneDecrementFactor() << std::endl;
-	cout << "stabi" << setw(6)<<right << plantGeneStabilizeFactor() << setw(6)<<right << herbivoreGeneStabilizeFactor() << setw(6)<<right << carnivoreGeneStabilizeFactor() << std::endl;
-	cout << "incre" << setw(6)<<right << plantGeneIncrementFactor() << setw(6)<<right << herbivoreGeneIncrementFactor() << setw(6)<<right << carnivoreGeneIncrementFactor() << std::endl;
-	cout << "feast" << setw(6)<<right << "-" << setw(6)<<right << herbivoreFeastSize() << setw(6)<<right << "-" << endl;
-	cout << endl;
+	Texel* texels = image.texels();
+	for (int r = 0; r < rows; ++r) {
+		for (int c = 0; c < columns; ++c) {
+			const DensityPyramid::Tile& tile = pyramid.tile(r, c);
+			int cellCount = pyramid.cellCount(r, c);
+			int organismCount = tile.plants + tile.herbivores + tile.carnivores;
+			std::int64_t energy = organismCount > 0 ? tile.energy / organismCount : 0;
+			*texels++ = {
+				std::uint8_t(255 * tile.plants / cellCount),
+				std::uint8_t(255 * tile.herbivores / cellCount),
+				std::uint8_t(255 * tile.carnivores / cellCount),
+				std::uint8_t(std::min<std::int64_t>(std::max<std::int64_t>(energy, 0) * 255 / 100, 255))
+			};
+		}
+	}
+}
 
+void GridWorldRenderer::render() const
+{
 	program.use();
+	if (snapshots.update()) {
+		cellTexture.setImage<Texel>(GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, snapshots.front().texels);
+	}
+	const Snapshot& snapshot = snapshots.front();
+	glUniform3f(viewportLocation, viewport.centerX, viewport.centerY, viewport.zoom);
+	glUniform2f(worldSizeLocation, snapshot.columns, snapshot.rows);
+	glUniform1f(tileSizeLocation, 1 << snapshot.level);
+	cellTexture.bind();
 	quadVertexArrayObject.bind();
-	instanceVertexBufferObject.setData(quads, GL_DYNAMIC_DRAW);
-	//std::cout << "size: " << quads.size() << std::endl;
-	glDrawArraysInstanced(GL_TRIANGLES, 0, 6, quads.size());
+	glDrawArrays(GL_TRIANGLES, 0, 6);
 	quadVertexArrayObject.unbind();
+	Texture::unbind();
 }
 
-std::string GridWorldRenderer::medianElement(std::vector<int>& v, std::string empty)
+#else // GRIDWORLD_RENDER_USE_TEXTURE
+
+void GridWorldRenderer::initializeShaders()
 {
-	if (v.empty()) {
-		return empty;
-	} else {
-		// NOTE: fuck evens
-		int i = v.size()/2;
-		std::nth_element(v.begin(), v.begin() + i, v.end());
-		return std::to_string(v[i]);
-	}
+	VertexShader vertexShader(
+		"#version 330 core\n"
+		"layout (location = 0) in vec2 position;\n"
+		"layout (location = 1) in vec2 offset;\n"
+		"layout (location = 2) in vec3 color;\n"
+		"out vec3 fColor;\n"
+		"void main()\n"
+		"{\n"
+		"	gl_Position = vec4(position + offset, 0.0f, 1.0f);\n"
+		"	fColor = color;\n"
+		"}\n"
+	);
+	FragmentShader fragmentShader(
+		"#version 330 core\n"
+		"in vec3 fColor;\n"
+		"out vec4 color;\n"
+		"void main()\n"
+		"{\n"
+		"	color = vec4(fColor, 1.0f);\n"
+		"}\n"
+	);
+
+	program = ShaderProgram(vertexShader, fragmentShader);
 }
 
-void GridWorldRenderer::OrganismStatistics::clear()
+// NOTE: the instances always cover the whole world
+void GridWorldRenderer::setViewport(const Viewport& /*viewport*/, int /*rows*/, int /*columns*/)
 {
-	energies.clear();
-	reproductionEnergies.clear();
-	offspringEnergies.clear();
-	geneDecrementFactors.clear();
-	geneStabilizeFactors.clear();
-	geneIncrementFactors.clear();
 }
 
-void GridWorldRenderer::OrganismStatistics::record(const Organism &organism)
+// NOTE: every new snapshot is written to another region, a grown buffer is
+// another buffer object
+void GridWorldRenderer::setInstanceAttributes() const
 {
-	energies.push_back(organism.energy);
-	reproductionEnergies.push_back(organism.reproductionEnergy);
-	offspringEnergies.push_back(organism.offspringEnergy);
-	geneDecrementFactors.push_back(organism.geneDecrementFactor);
-	geneStabilizeFactors.push_back(organism.geneStabilizeFactor);
-	geneIncrementFactors.push_back(organism.geneIncrementFactor);
+	GLintptr offset = instanceBuffer.offset();
+	instanceBuffer.bind();
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Quad), (GLvoid*)(offset + offsetof(Quad, position)));
+	glVertexAttribDivisor(1, 1);
+	glEnableVertexAttribArray(2);
+	glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Quad), (GLvoid*)(offset + offsetof(Quad, color)));
+	glVertexAttribDivisor(2, 1);
+	VertexBufferObject::unbind();
 }
 
-void GridWorldRenderer::HerbivoreStatistics::clear()
+// Blocks are counted and then filled in parallel, every block writes its
+// quads at the offset the prefix sum of the counts gives it, so the quads are
+// in the same order as in a serial walk and no locks are needed.
+void GridWorldRenderer::snapshot(const GridWorld& gridWorld)
 {
-	OrganismStatistics::clear();
-	feastSizes.clear();
+	if (!snapshots.isConsumed()) {
+		return;
+	}
+
+	std::vector<Quad>& quads = snapshots.back();
+
+	int rows = gridWorld.rows;
+	int columns = gridWorld.columns;
+	const BlockMap<Cell, GridWorld::BLOCK_ROWS, GridWorld::BLOCK_COLUMNS>& cellBlocks = gridWorld.cellBlocks;
+	int blockColumns = cellBlocks.columns();
+	int blockCount = cellBlocks.rows() * blockColumns;
+
+	blockOffsets.resize(blockCount + 1);
+	blockOffsets[0] = 0;
+	#pragma omp parallel for schedule(dynamic)
+	for (int b = 0; b < blockCount; ++b) {
+		const Block<Cell>& block = cellBlocks.block(b / blockColumns, b % blockColumns);
+		int count = 0;
+		for (int i = 0; i < block.rows(); ++i) {
+			for (int j = 0; j < block.columns(); ++j) {
+				const Cell &cell = block.cell(i, j);
+				count += int(cell.hasPlant()) + int(cell.hasHerbivore()) + int(cell.hasCarnivore());
+			}
+		}
+		blockOffsets[b + 1] = count;
+	}
+	std::partial_sum(blockOffsets.begin(), blockOffsets.end(), blockOffsets.begin());
+	quads.resize(blockOffsets[blockCount]);
+
+	#pragma omp parallel for schedule(dynamic)
+	for (int b = 0; b < blockCount; ++b) {
+		const Block<Cell>& block = cellBlocks.block(b / blockColumns, b % blockColumns);
+		Quad* quad = quads.data() + blockOffsets[b];
+		Position p((b / blockColumns) * GridWorld::BLOCK_ROWS, (b % blockColumns) * GridWorld::BLOCK_COLUMNS);
+		//std::uniform_real_distribution<float> cd(0.0f, 1.0f);
+		//glm::vec3 color(cd(mt), cd(mt), cd(mt));
+		for (int i = 0; i < block.rows(); ++i) {
+			Restorer<int> colRestorer(p.col);
+			GLfloat qy = 0.95f - GLfloat(1.90 * p.row) / rows;
+			for (int j = 0; j < block.columns(); ++j) {
+				const Cell &cell = block.cell(i, j);
+				GLfloat qx = 0.95f - GLfloat(1.90 * p.col) / columns;
+				if (cell.hasPlant()) {
+					*quad++ = {{qx, qy}, {0.0f, 1.0f, 0.0f}};
+					//*quad++ = {{qx, qy}, color};
+
+					if (cell.hasHerbivore()) {
+						*quad++ = {{qx, qy}, {0.0f, 0.1f, 1.0f}};
+					}
+					if (cell.hasCarnivore()) {
+						*quad++ = {{qx, qy}, {1.0f, 0.1f, 0.0f}};
+					}
+				} else {
+					if (cell.hasHerbivore()) {
+						*quad++ = {{qx, qy}, {0.0f, 0.0f, 1.0f}};
+					}
+					if (cell.hasCarnivore()) {
+						*quad++ = {{qx, qy}, {1.0f, 0.0f, 0.0f}};
+					}
+				}
+				p.col += 1;
+			}
+			p.row += 1;
+		}
+	}
+
+	snapshots.publish();
 }
 
-void GridWorldRenderer::HerbivoreStatistics::record(const Herbivore &herbivore)
+void GridWorldRenderer::render() const
 {
-	OrganismStatistics::record(herbivore);
-	feastSizes.push_back(herbivore.feastSize);
+	program.use();
+	quadVertexArrayObject.bind();
+	if (snapshots.update()) {
+		const std::vector<Quad>& quads = snapshots.front();
+		std::copy(quads.begin(), quads.end(), instanceBuffer.map(quads.size()));
+		instanceBuffer.unmap();
+		setInstanceAttributes();
+	}
+	//std::cout << "size: " << instanceBuffer.count() << std::endl;
+	glDrawArraysInstanced(GL_TRIANGLES, 0, 6, instanceBuffer.count());
+	instanceBuffer.fence();
+	quadVertexArrayObject.unbind();
 }
+
+#endif // GRIDWORLD_RENDER_USE_TEXTURE
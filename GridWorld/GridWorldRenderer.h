@@ -2,55 +2,57 @@
 #define RENDERER_H
 
 #include "Cell.h"
+#include "DensityPyramid.h"
 
 #include "../Buffer.h"
 #include "../Shader.h"
+#include "../Texture.h"
+#include "../TripleBuffer.h"
 #include "../VertexArrayObject.h"
+#include "../Viewport.h"
 
 #include <glm/vec2.hpp>
 #include <glm/vec3.hpp>
 
+#include <atomic>
+#include <cstdint>
 #include <vector>
 
-class GridWorld;
+// the species of every cell as four byte texels in a texture colored by the
+// fragment shader, instead of a 20 byte instance per organism, zoomed out the
+// densities of tiles of cells
+#define GRIDWORLD_RENDER_USE_TEXTURE 1
 
-class GridWorldRenderer
-{
-	struct OrganismStatistics
-	{
-		void clear();
+template <class CellType>
+class BasicGridWorld;
 
-		void record(const Organism& organism);
+typedef BasicGridWorld<Cell> GridWorld;
 
-		std::vector<int> energies;
-		std::vector<int> reproductionEnergies;
-		std::vector<int> offspringEnergies;
-		std::vector<int> geneDecrementFactors;
-		std::vector<int> geneStabilizeFactors;
-		std::vector<int> geneIncrementFactors;
-	};
-
-	struct PlantStatistics : public OrganismStatistics
-	{
-	};
-
-	struct HerbivoreStatistics : public OrganismStatistics
+class GridWorldRenderer
+{
+	struct Quad
 	{
-		void clear();
-
-		void record(const Herbivore& herbivore);
-
-		std::vector<int> feastSizes;
+		glm::vec2 position;
+		glm::vec3 color;
 	};
 
-	struct CarnivoreStatistics : public OrganismStatistics
+	// nonzero for the organisms present in a cell, or the densities of the
+	// organisms in a tile and their mean energy
+	struct Texel
 	{
+		std::uint8_t plant;
+		std::uint8_t herbivore;
+		std::uint8_t carnivore;
+		std::uint8_t energy;
 	};
 
-	struct Quad
+	// texels of cells at level 0, of tiles of 2^level cells on a side above
+	struct Snapshot
 	{
-		glm::vec2 position;
-		glm::vec3 color;
+		int level;
+		int rows;
+		int columns;
+		TiledImage<Texel>::Changes texels;
 	};
 
 public:
@@ -59,46 +61,51 @@ public:
 
 	void initialize();
 
-	void render(const GridWorld& gridWorld) const;
+	void snapshot(const GridWorld& gridWorld);
+
+	void render() const;
+
+	// Called on the render thread, the level of detail it needs is taken by
+	// the next snapshot.
+	void setViewport(const Viewport& viewport, int rows, int columns);
 
 private:
 
 	void initializeShaders();
 
+#if GRIDWORLD_RENDER_USE_TEXTURE
+	void setCellTexels(const GridWorld& gridWorld);
 
-	static std::string medianElement(std::vector<int>& v, std::string empty = "-");
+	void setTileTexels(const GridWorld& gridWorld, int level);
+#endif
 
-	std::string plantEnergy() const { return medianElement(plantStatistics.energies); }
-	std::string plantReproduction() const { return medianElement(plantStatistics.reproductionEnergies); }
-	std::string plantOffspring() const { return medianElement(plantStatistics.offspringEnergies); }
-	std::string plantGeneDecrementFactor() const { return medianElement(plantStatistics.geneDecrementFactors); }
-	std::string plantGeneStabilizeFactor() const { return medianElement(plantStatistics.geneStabilizeFactors); }
-	std::string plantGeneIncrementFactor() const { return medianElement(plantStatistics.geneIncrementFactors); }
+#if !GRIDWORLD_RENDER_USE_TEXTURE
+	void setInstanceAttributes() const;
+#endif
 
-	std::string herbivoreEnergy() const { return medianElement(herbivoreStatistics.energies); }
-	std::string herbivoreReproduction() const { return medianElement(herbivoreStatistics.reproductionEnergies); }
-	std::string herbivoreOffspring() const { return medianElement(herbivoreStatistics.offspringEnergies); }
-	std::string herbivoreGeneDecrementFactor() const { return medianElement(herbivoreStatistics.geneDecrementFactors); }
-	std::string herbivoreGeneStabilizeFactor() const { return medianElement(herbivoreStatistics.geneStabilizeFactors); }
-	std::string herbivoreGeneIncrementFactor() const { return medianElement(herbivoreStatistics.geneIncrementFactors); }
-	std::string herbivoreFeastSize() const { return medianElement(herbivoreStatistics.feastSizes); }
-
-	std::string carnivoreEnergy() const { return medianElement(carnivoreStatistics.energies); }
-	std::string carnivoreReproduction() const { return medianElement(carnivoreStatistics.reproductionEnergies); }
-	std::string carnivoreOffspring() const { return medianElement(carnivoreStatistics.offspringEnergies); }
-	std::string carnivoreGeneDecrementFactor() const { return medianElement(carnivoreStatistics.geneDecrementFactors); }
-	std::string carnivoreGeneStabilizeFactor() const { return medianElement(carnivoreStatistics.geneStabilizeFactors); }
-	std::string carnivoreGeneIncrementFactor() const { return medianElement(carnivoreStatistics.geneIncrementFactors); }
+private:
 
 	ShaderProgram program;
-	VertexBufferObject instanceVertexBufferObject;
 	VertexArrayObject quadVertexArrayObject;
 	VertexBufferObject quadVertexBufferObject;
 
-	mutable std::vector<Quad> quads;
-	mutable PlantStatistics plantStatistics;
-	mutable HerbivoreStatistics herbivoreStatistics;
-	mutable CarnivoreStatistics carnivoreStatistics;
+#if GRIDWORLD_RENDER_USE_TEXTURE
+	GLint viewportLocation;
+	GLint worldSizeLocation;
+	GLint tileSizeLocation;
+	Viewport viewport;
+	std::atomic<int> level;
+	mutable Texture cellTexture;
+	// only written by snapshot()
+	TiledImage<Texel> image;
+	DensityPyramid pyramid;
+	mutable TripleBuffer<Snapshot> snapshots;
+#else
+	mutable StreamingVertexBuffer<Quad> instanceBuffer;
+	mutable TripleBuffer<std::vector<Quad>> snapshots;
+	// quad offset of every block, only used by snapshot()
+	std::vector<int> blockOffsets;
+#endif
 };
 
 #endif // RENDERER_H
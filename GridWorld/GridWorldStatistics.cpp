@@ -0,0 +1,100 @@
+#include "GridWorldStatistics.h"
+
+#include <iomanip>
+#include <iostream>
+
+GridWorldStatistics::GridWorldStatistics()
+	: pipeline(&GridWorldStatistics::analyze)
+{
+}
+
+void GridWorldStatistics::collect()
+{
+	Sample* sample = pipeline.acquire();
+	if (!sample) {
+		return;
+	}
+
+	sample->droppedCount = pipeline.droppedCount();
+	sample->plants.set(plants);
+	sample->herbivores.set(herbivores);
+	sample->carnivores.set(carnivores);
+
+	pipeline.submit();
+}
+
+void GridWorldStatistics::analyze(Sample& sample)
+{
+	using namespace std;
+
+	OrganismSample& p = sample.plants;
+	HerbivoreSample& h = sample.herbivores;
+	OrganismSample& c = sample.carnivores;
+
+	cout << endl;
+	cout << "      plant herbi carni" << endl;
+	cout << "count" << setw(6)<<right << p.count << setw(6)<<right << h.count << setw(6)<<right << c.count << endl;
+	cout << "repro" << setw(6)<<right << medianElement(p.reproductionEnergy) << setw(6)<<right << medianElement(h.reproductionEnergy) << setw(6)<<right << medianElement(c.reproductionEnergy) << endl;
+	cout << "offsp" << setw(6)<<right << medianElement(p.offspringEnergy) << setw(6)<<right << medianElement(h.offspringEnergy) << setw(6)<<right << medianElement(c.offspringEnergy) << endl;
+	cout << "decre" << setw(6)<<right << medianElement(p.geneDecrementFactor) << setw(6)<<right << medianElement(h.geneDecrementFactor) << setw(6)<<right << medianElement(c.geneDecrementFactor) << endl;
+	cout << "stabi" << setw(6)<<right << medianElement(p.geneStabilizeFactor) << setw(6)<<right << medianElement(h.geneStabilizeFactor) << setw(6)<<right << medianElement(c.geneStabilizeFactor) << endl;
+	cout << "incre" << setw(6)<<right << medianElement(p.geneIncrementFactor) << setw(6)<<right << medianElement(h.geneIncrementFactor) << setw(6)<<right << medianElement(c.geneIncrementFactor) << endl;
+	cout << "feast" << setw(6)<<right << "-" << setw(6)<<right << medianElement(h.feastSize) << setw(6)<<right << "-" << endl;
+	cout << "dropped samples: " << sample.droppedCount << endl;
+	cout << endl;
+}
+
+std::string GridWorldStatistics::medianElement(int median, std::string empty)
+{
+	if (median < 0) {
+		return empty;
+	} else {
+		return std::to_string(median);
+	}
+}
+
+void GridWorldStatistics::OrganismHistograms::add(const Organism& organism)
+{
+	reproductionEnergies.add(organism.reproductionEnergy);
+	offspringEnergies.add(organism.offspringEnergy);
+	geneDecrementFactors.add(organism.geneDecrementFactor);
+	geneStabilizeFactors.add(organism.geneStabilizeFactor);
+	geneIncrementFactors.add(organism.geneIncrementFactor);
+}
+
+void GridWorldStatistics::OrganismHistograms::remove(const Organism& organism)
+{
+	reproductionEnergies.remove(organism.reproductionEnergy);
+	offspringEnergies.remove(organism.offspringEnergy);
+	geneDecrementFactors.remove(organism.geneDecrementFactor);
+	geneStabilizeFactors.remove(organism.geneStabilizeFactor);
+	geneIncrementFactors.remove(organism.geneIncrementFactor);
+}
+
+void GridWorldStatistics::HerbivoreHistograms::add(const Herbivore& herbivore)
+{
+	OrganismHistograms::add(herbivore);
+	feastSizes.add(herbivore.feastSize);
+}
+
+void GridWorldStatistics::HerbivoreHistograms::remove(const Herbivore& herbivore)
+{
+	OrganismHistograms::remove(herbivore);
+	feastSizes.remove(herbivore.feastSize);
+}
+
+void GridWorldStatistics::OrganismSample::set(const OrganismHistograms& histograms)
+{
+	count = histograms.reproductionEnergies.count();
+	reproductionEnergy = histograms.reproductionEnergies.median();
+	offspringEnergy = histograms.offspringEnergies.median();
+	geneDecrementFactor = histograms.geneDecrementFactors.median();
+	geneStabilizeFactor = histograms.geneStabilizeFactors.median();
+	geneIncrementFactor = histograms.geneIncrementFactors.median();
+}
+
+void GridWorldStatistics::HerbivoreSample::set(const HerbivoreHistograms& histograms)
+{
+	OrganismSample::set(histograms);
+	feastSize = histograms.feastSizes.median();
+}
@@ -0,0 +1,149 @@
+#ifndef GRIDWORLDSTATISTICS_H
+#define GRIDWORLDSTATISTICS_H
+
+#include "Cell.h"
+
+#include "../AnalysisPipeline.h"
+#include "../Histogram.h"
+
+#include <cstdint>
+#include <string>
+
+// Population and gene distributions of the organisms alive, kept up to date
+// by the births and deaths of the update. Genes never change during a life,
+// so collect() only reads the medians off the histograms, the table is
+// printed on the analysis thread.
+class GridWorldStatistics
+{
+public:
+	struct OrganismHistograms
+	{
+		void add(const Organism& organism);
+
+		void remove(const Organism& organism);
+
+		Histogram reproductionEnergies;
+		Histogram offspringEnergies;
+		Histogram geneDecrementFactors;
+		Histogram geneStabilizeFactors;
+		Histogram geneIncrementFactors;
+	};
+
+	struct HerbivoreHistograms : public OrganismHistograms
+	{
+		void add(const Herbivore& herbivore);
+
+		void remove(const Herbivore& herbivore);
+
+		Histogram feastSizes;
+	};
+
+private:
+	// medians, -1 without organisms
+	struct OrganismSample
+	{
+		void set(const OrganismHistograms& histograms);
+
+		int count;
+		int reproductionEnergy;
+		int offspringEnergy;
+		int geneDecrementFactor;
+		int geneStabilizeFactor;
+		int geneIncrementFactor;
+	};
+
+	struct HerbivoreSample : public OrganismSample
+	{
+		void set(const HerbivoreHistograms& histograms);
+
+		int feastSize;
+	};
+
+	struct Sample
+	{
+		OrganismSample plants;
+		HerbivoreSample herbivores;
+		OrganismSample carnivores;
+		std::uint64_t droppedCount;
+	};
+
+public:
+
+	GridWorldStatistics();
+
+	void add(const Plant& plant)
+	{
+		plants.add(plant);
+	}
+
+	void add(const Herbivore& herbivore)
+	{
+		herbivores.add(herbivore);
+	}
+
+	void add(const Carnivore& carnivore)
+	{
+		carnivores.add(carnivore);
+	}
+
+	void remove(const Plant& plant)
+	{
+		plants.remove(plant);
+	}
+
+	void remove(const Herbivore& herbivore)
+	{
+		herbivores.remove(herbivore);
+	}
+
+	void remove(const Carnivore& carnivore)
+	{
+		carnivores.remove(carnivore);
+	}
+
+	int plantCount() const
+	{
+		return plants.reproductionEnergies.count();
+	}
+
+	int herbivoreCount() const
+	{
+		return herbivores.reproductionEnergies.count();
+	}
+
+	int carnivoreCount() const
+	{
+		return carnivores.reproductionEnergies.count();
+	}
+
+	const OrganismHistograms& plantHistograms() const
+	{
+		return plants;
+	}
+
+	const HerbivoreHistograms& herbivoreHistograms() const
+	{
+		return herbivores;
+	}
+
+	const OrganismHistograms& carnivoreHistograms() const
+	{
+		return carnivores;
+	}
+
+	void collect();
+
+private:
+
+	static void analyze(Sample& sample);
+
+	static std::string medianElement(int median, std::string empty = "-");
+
+	OrganismHistograms plants;
+	HerbivoreHistograms herbivores;
+	OrganismHistograms carnivores;
+
+	AnalysisPipeline<Sample> pipeline;
+};
+
+#endif // GRIDWORLDSTATISTICS_H
@@ -0,0 +1,144 @@
+#include "GridWorldTelemetry.h"
+
+#include "GridWorld.h"
+
+#include <iterator>
+
+namespace {
+
+const int QUANTILE_COUNT = 3;
+
+const double quantileFractions[QUANTILE_COUNT] = {0.1, 0.5, 0.9};
+
+const char* const quantileNames[QUANTILE_COUNT] = {"p10", "p50", "p90"};
+
+const char* const organismGenes[] = {
+	"reproductionEnergy",
+	"offspringEnergy",
+	"geneDecrementFactor",
+	"geneStabilizeFactor",
+	"geneIncrementFactor",
+};
+
+void addColumns(std::vector<std::string>& columns, const std::string& species, bool herbivore)
+{
+	columns.push_back(species + ".count");
+	columns.push_back(species + ".births");
+	columns.push_back(species + ".deaths");
+	columns.push_back(species + ".moves");
+	columns.push_back(species + ".kills");
+
+	std::vector<std::string> genes(std::begin(organismGenes), std::end(organismGenes));
+	if (herbivore) {
+		genes.push_back("feastSize");
+	}
+	for (const std::string& gene : genes) {
+		for (const char* quantile : quantileNames) {
+			columns.push_back(species + "." + gene + "." + quantile);
+		}
+	}
+}
+
+} // namespace
+
+GridWorldTelemetry::GridWorldTelemetry()
+	: plantEvents{0, 0, 0, 0}
+	, herbivoreEvents{0, 0, 0, 0}
+	, carnivoreEvents{0, 0, 0, 0}
+	, recorded(false)
+{
+}
+
+std::vector<std::string> GridWorldTelemetry::columns()
+{
+	std::vector<std::string> columns;
+	addColumns(columns, "plant", false);
+	addColumns(columns, "herbivore", true);
+	addColumns(columns, "carnivore", false);
+#if CELL_ORGANISM_USE_LINEAGE
+#if CELL_PLANT_USE_LINEAGE
+	columns.push_back("plant.lineages");
+#endif
+	columns.push_back("herbivore.lineages");
+	columns.push_back("carnivore.lineages");
+	columns.push_back("phylogeny.nodes");
+#endif
+	return columns;
+}
+
+template <class CellType>
+void GridWorldTelemetry::record(const BasicGridWorld<CellType>& gridWorld, std::int32_t* values)
+{
+	if (!recorded) {
+		lastPlantEvents = plantEvents;
+		lastHerbivoreEvents = herbivoreEvents;
+		lastCarnivoreEvents = carnivoreEvents;
+		recorded = true;
+	}
+	publish(gridWorld.statistics);
+
+	values = write(plantEvents, lastPlantEvents, plantQuantiles, values);
+	values = write(herbivoreEvents, lastHerbivoreEvents, herbivoreQuantiles, values);
+	values = write(carnivoreEvents, lastCarnivoreEvents, carnivoreQuantiles, values);
+#if CELL_ORGANISM_USE_LINEAGE
+	const Phylogeny& phylogeny = gridWorld.phylogeny;
+#if CELL_PLANT_USE_LINEAGE
+	*values++ = phylogeny.lineageCount(Phylogeny::Plants);
+#endif
+	*values++ = phylogeny.lineageCount(Phylogeny::Herbivores);
+	*values++ = phylogeny.lineageCount(Phylogeny::Carnivores);
+	*values++ = std::int32_t(phylogeny.nodeCount());
+#endif
+}
+
+void GridWorldTelemetry::publish(const GridWorldStatistics& statistics)
+{
+	publish(statistics.plantHistograms(), plantQuantiles);
+	publish(statistics.herbivoreHistograms(), herbivoreQuantiles);
+	publish(statistics.herbivoreHistograms().feastSizes, herbivoreQuantiles);
+	publish(statistics.carnivoreHistograms(), carnivoreQuantiles);
+}
+
+void GridWorldTelemetry::publish(const OrganismHistograms& histograms, std::vector<std::int32_t>& quantiles)
+{
+	quantiles.clear();
+	publish(histograms.reproductionEnergies, quantiles);
+	publish(histograms.offspringEnergies, quantiles);
+	publish(histograms.geneDecrementFactors, quantiles);
+	publish(histograms.geneStabilizeFactors, quantiles);
+	publish(histograms.geneIncrementFactors, quantiles);
+}
+
+void GridWorldTelemetry::publish(const Histogram& histogram, std::vector<std::int32_t>& quantiles)
+{
+	int values[QUANTILE_COUNT];
+	histogram.quantiles(quantileFractions, values, QUANTILE_COUNT);
+	quantiles.insert(quantiles.end(), std::begin(values), std::end(values));
+}
+
+// NOTE: in the order of the columns
+std::int32_t* GridWorldTelemetry::write(const Events& events, Events& lastEvents, const std::vector<std::int32_t>& quantiles, std::int32_t* values)
+{
+	*values++ = std::int32_t(events.births - events.deaths);
+	*values++ = std::int32_t(events.births - lastEvents.births);
+	*values++ = std::int32_t(events.deaths - lastEvents.deaths);
+	*values++ = std::int32_t(events.moves - lastEvents.moves);
+	*values++ = std::int32_t(events.kills - lastEvents.kills);
+	lastEvents = events;
+
+	for (std::int32_t quantile : quantiles) {
+		*values++ = quantile;
+	}
+	return values;
+}
+
+#ifdef GRIDWORLD_CELL_VARIANTS
+template void GridWorldTelemetry::record(const BasicGridWorld<InlineCell>& gridWorld, std::int32_t* values);
+template void GridWorldTelemetry::record(const BasicGridWorld<HeapCell>& gridWorld, std::int32_t* values);
+template void GridWorldTelemetry::record(const BasicGridWorld<RetainedCell>& gridWorld, std::int32_t* values);
+template void GridWorldTelemetry::record(const BasicGridWorld<PimplInlineCell>& gridWorld, std::int32_t* values);
+template void GridWorldTelemetry::record(const BasicGridWorld<PimplHeapCell>& gridWorld, std::int32_t* values);
+template void GridWorldTelemetry::record(const BasicGridWorld<PimplRetainedCell>& gridWorld, std::int32_t* values);
+#else
+template void GridWorldTelemetry::record(const GridWorld& gridWorld, std::int32_t* values);
+#endif
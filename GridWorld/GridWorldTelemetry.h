@@ -0,0 +1,131 @@
+#ifndef GRIDWORLDTELEMETRY_H
+#define GRIDWORLDTELEMETRY_H
+
+#include "Cell.h"
+#include "GridWorldStatistics.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+template <class CellType>
+class BasicGridWorld;
+
+typedef BasicGridWorld<Cell> GridWorld;
+
+// Values of every tick of a GridWorld for the TelemetryWriter: per species
+// the population, the births, deaths, moves and kills of the tick, and the
+// 10th, 50th and 90th percentiles of the genes. With lineages, the founders
+// with descendants alive and the size of the phylogeny.
+//
+// The events are counted as they happen and the populations follow from the
+// births and deaths. The quantiles of every tick are exact, they are read off
+// the gene histograms of the GridWorldStatistics, which the world keeps up to
+// date with every birth and death once telemetry is recorded.
+class GridWorldTelemetry
+{
+	// since the world was created
+	struct Events
+	{
+		std::uint64_t births;
+		std::uint64_t deaths;
+		std::uint64_t moves;
+		std::uint64_t kills;
+	};
+
+public:
+	GridWorldTelemetry();
+
+	static std::vector<std::string> columns();
+
+	// the statistics of the world are started
+	template <class CellType>
+	void record(const BasicGridWorld<CellType>& gridWorld, std::int32_t* values);
+
+	// births less deaths
+	int organismCount() const
+	{
+		return int(plantEvents.births - plantEvents.deaths
+			+ herbivoreEvents.births - herbivoreEvents.deaths
+			+ carnivoreEvents.births - carnivoreEvents.deaths);
+	}
+
+	void born(const Plant& /*plant*/)
+	{
+		plantEvents.births += 1;
+	}
+
+	void born(const Herbivore& /*herbivore*/)
+	{
+		herbivoreEvents.births += 1;
+	}
+
+	void born(const Carnivore& /*carnivore*/)
+	{
+		carnivoreEvents.births += 1;
+	}
+
+	void died(const Plant& /*plant*/)
+	{
+		plantEvents.deaths += 1;
+	}
+
+	void died(const Herbivore& /*herbivore*/)
+	{
+		herbivoreEvents.deaths += 1;
+	}
+
+	void died(const Carnivore& /*carnivore*/)
+	{
+		carnivoreEvents.deaths += 1;
+	}
+
+	void moved(const Herbivore& /*herbivore*/)
+	{
+		herbivoreEvents.moves += 1;
+	}
+
+	void moved(const Carnivore& /*carnivore*/)
+	{
+		carnivoreEvents.moves += 1;
+	}
+
+	void preyed(const Herbivore& /*herbivore*/)
+	{
+		herbivoreEvents.kills += 1;
+	}
+
+	void preyed(const Carnivore& /*carnivore*/)
+	{
+		carnivoreEvents.kills += 1;
+	}
+
+private:
+	typedef GridWorldStatistics::OrganismHistograms OrganismHistograms;
+
+	void publish(const GridWorldStatistics& statistics);
+
+	static void publish(const OrganismHistograms& histograms, std::vector<std::int32_t>& quantiles);
+
+	static void publish(const Histogram& histogram, std::vector<std::int32_t>& quantiles);
+
+	static std::int32_t* write(const Events& events, Events& lastEvents, const std::vector<std::int32_t>& quantiles, std::int32_t* values);
+
+private:
+	Events plantEvents;
+	Events herbivoreEvents;
+	Events carnivoreEvents;
+
+	// at the previous record()
+	bool recorded;
+	Events lastPlantEvents;
+	Events lastHerbivoreEvents;
+	Events lastCarnivoreEvents;
+
+	// in the order of the columns
+	std::vector<std::int32_t> plantQuantiles;
+	std::vector<std::int32_t> herbivoreQuantiles;
+	std::vector<std::int32_t> carnivoreQuantiles;
+};
+
+#endif // GRIDWORLDTELEMETRY_H
@@ -0,0 +1,171 @@
+#include "Phylogeny.h"
+
+#include <algorithm>
+
+constexpr std::uint32_t Phylogeny::NONE;
+constexpr int Phylogeny::CHUNK_BITS;
+constexpr std::uint32_t Phylogeny::CHUNK_MASK;
+constexpr std::uint8_t Phylogeny::FREE;
+
+namespace {
+
+// NOTE: below this splicing is not worth a pass over the nodes
+const std::uint32_t MIN_SPLICED_NODE_COUNT = 1 << 16;
+
+// least nodes a tick freed, and visited or freed by a splice pass
+const std::uint32_t MIN_PRUNED_NODE_COUNT = 1 << 12;
+
+// ticks a splice pass is spread over
+const std::uint32_t SPLICE_TICK_COUNT = 32;
+
+} // namespace
+
+Phylogeny::Phylogeny()
+	: arena(sizeof(Node) << CHUNK_BITS)
+	, nodeCapacity(0)
+	, freeList(NONE)
+	, liveNodeCount(0)
+	, bornNodeCount(0)
+	, splicedNodeCount(0)
+	, spliceCursor(NONE)
+	, rootCounts{0, 0, 0}
+{
+}
+
+std::uint32_t Phylogeny::found(Species species, std::uint32_t tick, int geneIncrementFactor, int feastSize)
+{
+	std::uint32_t id = allocate();
+	node(id) = {NONE, 0, tick, geneIncrementFactor, feastSize, species, true};
+	rootCounts[species] += 1;
+	return id;
+}
+
+std::uint32_t Phylogeny::descend(std::uint32_t parent, std::uint32_t tick, int geneIncrementFactor, int feastSize)
+{
+	std::uint32_t id = allocate();
+	Node& p = node(parent);
+	p.children += 1;
+	node(id) = {parent, 0, tick, geneIncrementFactor, feastSize, p.species, true};
+	return id;
+}
+
+// NOTE: every node is freed once, so freeing twice the births keeps up
+// with the deaths and a mass extinction is spread over the following ticks
+void Phylogeny::prune()
+{
+	release(std::max(MIN_PRUNED_NODE_COUNT, 2 * bornNodeCount));
+	bornNodeCount = 0;
+
+	if (spliceCursor == NONE && liveNodeCount > std::max(2 * splicedNodeCount, MIN_SPLICED_NODE_COUNT)) {
+		spliceCursor = 0;
+	}
+	if (spliceCursor != NONE) {
+		splice(std::max(MIN_PRUNED_NODE_COUNT, nodeCapacity / SPLICE_TICK_COUNT));
+	}
+}
+
+void Phylogeny::flush()
+{
+	release(NONE);
+	if (spliceCursor != NONE) {
+		splice(NONE);
+	}
+}
+
+void Phylogeny::release(std::uint32_t count)
+{
+	for (; count > 0 && !extinct.empty(); --count) {
+		std::uint32_t id = extinct.back();
+		extinct.pop_back();
+
+		const Node& n = node(id);
+		std::uint32_t parent = n.parent;
+		if (parent == NONE) {
+			rootCounts[n.species] -= 1;
+		}
+		free(id);
+
+		if (parent != NONE) {
+			Node& p = node(parent);
+			p.children -= 1;
+			if (!p.alive && p.children == 0) {
+				extinct.push_back(parent);
+			}
+		}
+	}
+}
+
+// NOTE: a dead ancestor with a single child is only reached from that
+// child, so every chain is spliced exactly once. Queued extinct nodes have
+// no children and are never spliced, nodes born behind the cursor wait for
+// the next pass. A chain cut short by the count is resumed from the same node.
+void Phylogeny::splice(std::uint32_t count)
+{
+	while (count > 0 && spliceCursor < nodeCapacity) {
+		count -= 1;
+		Node& n = node(spliceCursor);
+		if (n.species != FREE) {
+			std::uint32_t parent = n.parent;
+			while (parent != NONE && count > 0) {
+				const Node& p = node(parent);
+				if (p.alive || p.children != 1 || p.parent == NONE) {
+					break;
+				}
+				std::uint32_t grandparent = p.parent;
+				free(parent);
+				parent = grandparent;
+				count -= 1;
+			}
+			n.parent = parent;
+			if (count == 0) {
+				break;
+			}
+		}
+		spliceCursor += 1;
+	}
+	if (spliceCursor == nodeCapacity) {
+		spliceCursor = NONE;
+		splicedNodeCount = liveNodeCount;
+	}
+}
+
+void Phylogeny::write(std::ostream& out) const
+{
+	out << "id,parent,species,birthTick,alive,children,geneIncrementFactor,feastSize\n";
+	for (std::uint32_t id = 0; id < nodeCapacity; ++id) {
+		const Node& n = node(id);
+		if (n.species == FREE) {
+			continue;
+		}
+		out << id << ',';
+		if (n.parent != NONE) {
+			out << n.parent;
+		}
+		out << ',' << int(n.species) << ',' << n.birthTick << ',' << n.alive << ',' << n.children
+			<< ',' << n.geneIncrementFactor << ',' << n.feastSize << '\n';
+	}
+}
+
+std::uint32_t Phylogeny::allocate()
+{
+	liveNodeCount += 1;
+	bornNodeCount += 1;
+	if (freeList != NONE) {
+		std::uint32_t id = freeList;
+		freeList = node(id).parent;
+		return id;
+	}
+	if ((nodeCapacity & CHUNK_MASK) == 0) {
+		chunks.push_back(arena.allocate<Node>(std::size_t(1) << CHUNK_BITS));
+	}
+	return nodeCapacity++;
+}
+
+void Phylogeny::free(std::uint32_t id)
+{
+	Node& n = node(id);
+	n.species = FREE;
+	n.parent = freeList;
+	freeList = id;
+	liveNodeCount -= 1;
+}
@@ -0,0 +1,126 @@
+#ifndef PHYLOGENY_H
+#define PHYLOGENY_H
+
+#include "../Arena.h"
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+// Ancestry of the organisms alive. Every birth adds a node linked to the
+// parent's node, founders are roots. Nodes live in chunks allocated from an
+// arena and are reused through a free list.
+//
+// A node is kept while its organism is alive or it has children. Deaths
+// only queue the childless nodes, prune() frees the extinct branches and
+// counts down the children of their parents. Once the tree has doubled, prune() also
+// splices out dead ancestors with a single child, so the tree stays within
+// about twice the organisms alive however many births there were. Roots are
+// never spliced, every node keeps its founder.
+//
+// prune() runs every tick and bounds its work: it frees about twice the
+// nodes born since the last call, and a splice pass goes over a slice of the
+// nodes a tick. flush() finishes both before the tree is written.
+class Phylogeny
+{
+public:
+	enum Species : std::uint8_t
+	{
+		Plants,
+		Herbivores,
+		Carnivores,
+		SPECIES_COUNT
+	};
+
+	static constexpr std::uint32_t NONE = 0xffffffff;
+
+	// genes whose lineages are followed, feastSize is -1 but for herbivores
+	struct Node
+	{
+		std::uint32_t parent;
+		std::uint32_t children;
+		std::uint32_t birthTick;
+		std::int32_t geneIncrementFactor;
+		std::int32_t feastSize;
+		std::uint8_t species;
+		bool alive;
+	};
+
+	Phylogeny();
+
+	Phylogeny(const Phylogeny& other) = delete;
+
+	Phylogeny& operator=(const Phylogeny& other) = delete;
+
+	std::uint32_t found(Species species, std::uint32_t tick, int geneIncrementFactor, int feastSize);
+
+	std::uint32_t descend(std::uint32_t parent, std::uint32_t tick, int geneIncrementFactor, int feastSize);
+
+	void died(std::uint32_t id)
+	{
+		Node& n = node(id);
+		n.alive = false;
+		if (n.children == 0) {
+			extinct.push_back(id);
+		}
+	}
+
+	void prune();
+
+	void flush();
+
+	const Node& node(std::uint32_t id) const
+	{
+		return chunks[id >> CHUNK_BITS][id & CHUNK_MASK];
+	}
+
+	std::uint32_t nodeCount() const
+	{
+		return liveNodeCount;
+	}
+
+	// founders with descendants alive
+	int lineageCount(Species species) const
+	{
+		return rootCounts[species];
+	}
+
+	// the nodes as CSV, one per line
+	void write(std::ostream& out) const;
+
+private:
+	static constexpr int CHUNK_BITS = 15;
+	static constexpr std::uint32_t CHUNK_MASK = (1 << CHUNK_BITS) - 1;
+
+	// marks free nodes, their parent links the free list
+	static constexpr std::uint8_t FREE = 0xff;
+
+	Node& node(std::uint32_t id)
+	{
+		return chunks[id >> CHUNK_BITS][id & CHUNK_MASK];
+	}
+
+	std::uint32_t allocate();
+
+	void free(std::uint32_t id);
+
+	void release(std::uint32_t count);
+
+	void splice(std::uint32_t count);
+
+	Arena arena;
+	std::vector<Node*> chunks;
+	std::uint32_t nodeCapacity;
+	std::uint32_t freeList;
+
+	std::uint32_t liveNodeCount;
+	std::uint32_t bornNodeCount;
+	std::uint32_t splicedNodeCount;
+	// next node of the running splice pass, NONE between passes
+	std::uint32_t spliceCursor;
+	int rootCounts[SPECIES_COUNT];
+
+	std::vector<std::uint32_t> extinct;
+};
+
+#endif // PHYLOGENY_H
@@ -0,0 +1,148 @@
+#include "HeadlessApplication.h"
+
+#include "PhaseTrace.h"
+
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+HeadlessApplication::HeadlessApplication(std::unique_ptr<Simulation> world, int tickCount)
+	: world(std::move(world))
+	, tickCount(tickCount)
+{
+}
+
+void HeadlessApplication::setFrameWriter(std::unique_ptr<FrameWriter> frameWriter)
+{
+	this->frameWriter = std::move(frameWriter);
+}
+
+void HeadlessApplication::setTelemetryWriter(std::unique_ptr<TelemetryWriter> telemetryWriter)
+{
+	this->telemetryWriter = std::move(telemetryWriter);
+}
+
+void HeadlessApplication::setPhylogenyPath(const std::string& phylogenyPath)
+{
+	this->phylogenyPath = phylogenyPath;
+}
+
+void HeadlessApplication::enablePerfCounters()
+{
+	perfCounters = std::make_unique<PerfCounters>();
+}
+
+bool HeadlessApplication::run()
+{
+	if (perfCounters && (frameWriter || telemetryWriter)) {
+		std::cout << "Perf counters cannot be combined with a capture or telemetry, their threads would be counted too" << std::endl;
+		return false;
+	}
+
+	// NOTE: before initialize() starts the OpenMP workers, so they inherit
+	// the counters
+	if (perfCounters && !perfCounters->open()) {
+		std::cout << "perf counters unavailable: " << perfCounters->error() << std::endl;
+		perfCounters.reset();
+	}
+
+	if (!world->initialize()) {
+		std::cout << "World initialization failed" << std::endl;
+		return false;
+	}
+
+	double organismUpdates = 0;
+
+	auto start = std::chrono::steady_clock::now();
+	if (frameWriter) {
+		frameWriter->capture(*world, 0);
+	}
+	if (telemetryWriter) {
+		telemetryWriter->record(*world, 0);
+	}
+	for (int i = 0; i < tickCount; ++i) {
+		if (perfCounters) {
+			organismUpdates += world->organismCount();
+			perfCounters->start();
+		}
+		world->update();
+		if (perfCounters) {
+			perfCounters->stop();
+		}
+		if (frameWriter) {
+			frameWriter->capture(*world, i + 1);
+		}
+		if (telemetryWriter) {
+			telemetryWriter->record(*world, i + 1);
+		}
+	}
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+	double seconds = elapsed.count();
+	double cellUpdates = double(tickCount) * world->cellCount();
+	std::cout << "ticks: " << tickCount << std::endl;
+	std::cout << "cells: " << world->cellCount() << std::endl;
+	std::cout << "seconds: " << seconds << std::endl;
+	if (seconds > 0) {
+		std::cout << "ticks/s: " << tickCount / seconds << std::endl;
+		std::cout << "cell-updates/s: " << cellUpdates / seconds << std::endl;
+		PhaseTrace::report(std::cout, seconds);
+	}
+	if (frameWriter) {
+		frameWriter->finish();
+		std::cout << "frames written: " << frameWriter->writtenCount() << std::endl;
+		std::cout << "frames dropped: " << frameWriter->droppedCount() << std::endl;
+	}
+	if (telemetryWriter) {
+		telemetryWriter->finish();
+		std::cout << "telemetry ticks written: " << telemetryWriter->writtenCount() << std::endl;
+		std::cout << "telemetry ticks dropped: " << telemetryWriter->droppedCount() << std::endl;
+	}
+	if (perfCounters) {
+		reportPerfCounters(cellUpdates, organismUpdates);
+	}
+
+	if (!phylogenyPath.empty()) {
+		std::ofstream out(phylogenyPath);
+		if (!world->writePhylogeny(out)) {
+			std::cout << "The world has no lineages, GridWorld tracks them when built with CELL_ORGANISM_USE_LINEAGE=1" << std::endl;
+			return false;
+		}
+		if (!out.flush()) {
+			std::cout << "Writing the phylogeny to " << phylogenyPath << " failed" << std::endl;
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void HeadlessApplication::reportPerfCounters(double cellUpdates, double organismUpdates) const
+{
+	if (!perfCounters->error().empty()) {
+		std::cout << "perf counters " << perfCounters->error() << std::endl;
+	}
+	std::cout << "organisms/tick: " << std::fixed << std::setprecision(1)
+		<< (tickCount > 0 ? organismUpdates / tickCount : 0) << std::defaultfloat << std::endl;
+	std::cout << std::left << std::setw(14) << "counter" << std::right
+		<< std::setw(16) << "total" << std::setw(12) << "per cell" << std::setw(14) << "per organism" << std::endl;
+	for (int i = 0; i < PerfCounters::COUNTER_COUNT; ++i) {
+		PerfCounters::Counter counter = PerfCounters::Counter(i);
+		double value = perfCounters->value(counter);
+		if (value < 0) {
+			continue;
+		}
+		std::cout << std::left << std::setw(14) << PerfCounters::name(counter) << std::right
+			<< std::fixed << std::setprecision(0) << std::setw(16) << value
+			<< std::setprecision(3) << std::setw(12) << (cellUpdates > 0 ? value / cellUpdates : 0)
+			<< std::setw(14) << (organismUpdates > 0 ? value / organismUpdates : 0)
+			<< std::defaultfloat << std::endl;
+	}
+
+	double cycles = perfCounters->value(PerfCounters::Cycles);
+	double instructions = perfCounters->value(PerfCounters::Instructions);
+	if (cycles > 0 && instructions >= 0) {
+		std::cout << "instructions/cycle: " << instructions / cycles << std::endl;
+	}
+}
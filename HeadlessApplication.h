@@ -0,0 +1,49 @@
+#ifndef HEADLESSAPPLICATION_H
+#define HEADLESSAPPLICATION_H
+
+#include "FrameWriter.h"
+#include "PerfCounters.h"
+#include "Simulation.h"
+#include "TelemetryWriter.h"
+
+#include <memory>
+#include <string>
+
+// Runs a world for a fixed number of ticks without a window, as fast as
+// possible, and reports the throughput.
+class HeadlessApplication
+{
+public:
+	HeadlessApplication(std::unique_ptr<Simulation> world, int tickCount);
+
+	// captures the ticks while running, the capture counts into the
+	// throughput
+	void setFrameWriter(std::unique_ptr<FrameWriter> frameWriter);
+
+	// records every tick, the recording counts into the throughput
+	void setTelemetryWriter(std::unique_ptr<TelemetryWriter> telemetryWriter);
+
+	// writes the phylogeny of the world as CSV after the last tick
+	void setPhylogenyPath(const std::string& phylogenyPath);
+
+	// counts hardware events of the updates and reports them per cell and
+	// per organism, runs without them where they are unavailable. The
+	// capture and telemetry threads would be counted too, run() refuses
+	// them together.
+	void enablePerfCounters();
+
+	bool run();
+
+private:
+	void reportPerfCounters(double cellUpdates, double organismUpdates) const;
+
+	std::unique_ptr<Simulation> world;
+	std::unique_ptr<FrameWriter> frameWriter;
+	std::unique_ptr<TelemetryWriter> telemetryWriter;
+	std::unique_ptr<PerfCounters> perfCounters;
+	std::string phylogenyPath;
+
+	int tickCount;
+};
+
+#endif // HEADLESSAPPLICATION_H
@@ -0,0 +1,84 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+// Exact counts of small non-negative values that come and go one at a time.
+// Values are also counted in blocks of BLOCK_SIZE, so the median and the
+// quantiles are found by walking the blocks and then the values of one
+// block, instead of walking all the values. Negative values count as 0.
+class Histogram
+{
+public:
+	Histogram()
+		: mCount(0)
+	{
+	}
+
+	void add(int value)
+	{
+		value = std::max(value, 0);
+		if (value >= int(counts.size())) {
+			counts.resize(value + 1, 0);
+			blockCounts.resize(value / BLOCK_SIZE + 1, 0);
+		}
+		counts[value] += 1;
+		blockCounts[value / BLOCK_SIZE] += 1;
+		mCount += 1;
+	}
+
+	void remove(int value)
+	{
+		value = std::max(value, 0);
+		assert(value < int(counts.size()) && counts[value] > 0);
+		counts[value] -= 1;
+		blockCounts[value / BLOCK_SIZE] -= 1;
+		mCount -= 1;
+	}
+
+	int count() const
+	{
+		return mCount;
+	}
+
+	// the value at count() / 2 in sorted order, -1 when empty
+	int median() const
+	{
+		return mCount > 0 ? valueAt(mCount / 2) : -1;
+	}
+
+	// the values at the given fractions of count() in sorted order, -1 when
+	// empty
+	void quantiles(const double* fractions, int* values, int n) const
+	{
+		for (int i = 0; i < n; ++i) {
+			values[i] = mCount > 0 ? valueAt(std::min(int(fractions[i] * mCount), mCount - 1)) : -1;
+		}
+	}
+
+private:
+	static constexpr int BLOCK_SIZE = 64;
+
+	int valueAt(int rank) const
+	{
+		int block = 0;
+		while (rank >= blockCounts[block]) {
+			rank -= blockCounts[block];
+			++block;
+		}
+		int value = block * BLOCK_SIZE;
+		while (rank >= counts[value]) {
+			rank -= counts[value];
+			++value;
+		}
+		return value;
+	}
+
+	std::vector<int> counts;
+	std::vector<int> blockCounts;
+	int mCount;
+};
+
+#endif // HISTOGRAM_H
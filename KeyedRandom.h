@@ -0,0 +1,50 @@
+#ifndef KEYEDRANDOM_H
+#define KEYEDRANDOM_H
+
+#include <cstdint>
+
+// Counter based generator: the stream is fully determined by its key
+// (seed, tick, stream, cell), so draws made for a cell do not depend on the
+// order in which cells are visited.
+class KeyedRandom
+{
+public:
+	typedef std::uint32_t result_type;
+
+	KeyedRandom(std::uint64_t seed, std::uint64_t tick, int stream, int row, int col)
+		: state(mix(mix(mix(seed + std::uint64_t(stream) * increment) ^ tick)
+			^ ((std::uint64_t(std::uint32_t(row)) << 32) | std::uint32_t(col))))
+	{
+	}
+
+	static constexpr result_type min()
+	{
+		return 0;
+	}
+
+	static constexpr result_type max()
+	{
+		return UINT32_MAX;
+	}
+
+	result_type operator()()
+	{
+		state += increment;
+		return result_type(mix(state) >> 32);
+	}
+
+private:
+	static constexpr std::uint64_t increment = 0x9e3779b97f4a7c15ull;
+
+	// splitmix64 finalizer
+	static std::uint64_t mix(std::uint64_t z)
+	{
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+		return z ^ (z >> 31);
+	}
+
+	std::uint64_t state;
+};
+
+#endif // KEYEDRANDOM_H
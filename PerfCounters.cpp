@@ -0,0 +1,163 @@
+#include "PerfCounters.h"
+
+#include <cerrno>
+#include <cstring>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+#ifdef __linux__
+
+struct CounterConfig
+{
+	std::uint32_t type;
+	std::uint64_t config;
+};
+
+const CounterConfig configs[PerfCounters::COUNTER_COUNT] = {
+	{PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+	{PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+	{PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES},
+	{PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+	{PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+	{PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_INSTRUCTIONS},
+	{PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+};
+
+// NOTE: user space only, allowed up to perf_event_paranoid 2
+int openCounter(const CounterConfig& counter)
+{
+	perf_event_attr attr;
+	std::memset(&attr, 0, sizeof(attr));
+	attr.size = sizeof(attr);
+	attr.type = counter.type;
+	attr.config = counter.config;
+	attr.disabled = 1;
+	attr.inherit = 1;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+	return int(::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+}
+
+#endif
+
+} // namespace
+
+PerfCounters::PerfCounters()
+{
+	fds.fill(-1);
+}
+
+PerfCounters::~PerfCounters()
+{
+#ifdef __linux__
+	for (int fd : fds) {
+		if (fd >= 0) {
+			::close(fd);
+		}
+	}
+#endif
+}
+
+bool PerfCounters::open()
+{
+#ifdef __linux__
+	mError.clear();
+	std::string missing;
+	int error = 0;
+	for (int i = 0; i < COUNTER_COUNT; ++i) {
+		fds[i] = openCounter(configs[i]);
+		if (fds[i] < 0) {
+			error = errno;
+			missing += std::string(missing.empty() ? "" : ", ") + name(Counter(i));
+		}
+	}
+	if (!available()) {
+		mError = std::string("perf_event_open: ") + std::strerror(error);
+		if (error == EACCES || error == EPERM) {
+			mError += ", see /proc/sys/kernel/perf_event_paranoid";
+		} else if (error == ENOENT || error == EOPNOTSUPP) {
+			mError += ", no hardware counters on this machine";
+		}
+		return false;
+	}
+	if (!missing.empty()) {
+		mError = "not counted: " + missing;
+	}
+	return true;
+#else
+	mError = "hardware counters are only supported on Linux";
+	return false;
+#endif
+}
+
+bool PerfCounters::available() const
+{
+	for (int fd : fds) {
+		if (fd >= 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void PerfCounters::start()
+{
+#ifdef __linux__
+	for (int fd : fds) {
+		if (fd >= 0) {
+			::ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+		}
+	}
+#endif
+}
+
+void PerfCounters::stop()
+{
+#ifdef __linux__
+	for (int fd : fds) {
+		if (fd >= 0) {
+			::ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+		}
+	}
+#endif
+}
+
+double PerfCounters::value(Counter counter) const
+{
+#ifdef __linux__
+	// value, time enabled, time running, summed over the inheriting threads
+	std::uint64_t values[3];
+	if (fds[counter] < 0 || ::read(fds[counter], values, sizeof(values)) != ssize_t(sizeof(values))) {
+		return -1;
+	}
+	if (values[2] == 0) {
+		return 0;
+	}
+	return double(values[0]) * values[1] / values[2];
+#else
+	(void)counter;
+	return -1;
+#endif
+}
+
+const char* PerfCounters::name(Counter counter)
+{
+	static const char* const names[COUNTER_COUNT] = {
+		"cycles",
+		"instructions",
+		"cache-refs",
+		"cache-misses",
+		"L1d-misses",
+		"branches",
+		"branch-misses",
+	};
+	return names[counter];
+}
@@ -0,0 +1,67 @@
+#ifndef PERFCOUNTERS_H
+#define PERFCOUNTERS_H
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+// Hardware counters of the calling thread and of the threads it starts after
+// open(), summed over the intervals between start() and stop(). Linux only,
+// through perf_event_open. Counters the kernel or the machine does not allow
+// are left out, available() is false when none is left.
+class PerfCounters
+{
+public:
+	enum Counter
+	{
+		Cycles,
+		Instructions,
+		CacheReferences,
+		CacheMisses,
+		L1DataMisses,
+		Branches,
+		BranchMisses,
+		COUNTER_COUNT
+	};
+
+	PerfCounters();
+
+	~PerfCounters();
+
+	PerfCounters(const PerfCounters&) = delete;
+
+	PerfCounters& operator=(const PerfCounters&) = delete;
+
+	// NOTE: before the threads to be counted are started, OpenMP workers
+	// only inherit counters open when they are created
+	bool open();
+
+	bool available() const;
+
+	// why open() failed, or which counters are left out
+	const std::string& error() const
+	{
+		return mError;
+	}
+
+	void start();
+
+	void stop();
+
+	bool counted(Counter counter) const
+	{
+		return fds[counter] >= 0;
+	}
+
+	// scaled up when the counter was multiplexed with others, -1 when it is
+	// not counted
+	double value(Counter counter) const;
+
+	static const char* name(Counter counter);
+
+private:
+	std::array<int, COUNTER_COUNT> fds;
+	std::string mError;
+};
+
+#endif // PERFCOUNTERS_H
@@ -0,0 +1,110 @@
+#include "PhaseTrace.h"
+
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+
+namespace {
+
+std::mutex registryMutex;
+
+std::atomic<bool> tracing(false);
+PhaseTrace::Clock::time_point traceStart;
+
+} // namespace
+
+constexpr std::size_t PhaseTrace::MAX_THREAD_EVENTS;
+
+PhaseTrace::Phase& PhaseTrace::phase(const char* name)
+{
+	std::lock_guard<std::mutex> lock(registryMutex);
+	for (Phase& phase : phases()) {
+		if (std::strcmp(phase.name, name) == 0) {
+			return phase;
+		}
+	}
+	phases().emplace_back(name);
+	return phases().back();
+}
+
+void PhaseTrace::startTrace()
+{
+	traceStart = Clock::now();
+	tracing.store(true, std::memory_order_release);
+}
+
+// NOTE: complete events ("ph": "X") in microseconds, nested scopes of a
+// thread nest in the viewer
+bool PhaseTrace::writeTrace(const std::string& path)
+{
+	std::ofstream file(path);
+	if (!file) {
+		return false;
+	}
+
+	file << "{\"traceEvents\":[" << std::fixed << std::setprecision(1);
+	bool first = true;
+	std::lock_guard<std::mutex> registryLock(registryMutex);
+	for (const std::unique_ptr<ThreadEvents>& thread : threads()) {
+		std::lock_guard<std::mutex> lock(thread->mutex);
+		for (const Event& event : thread->events) {
+			file << (first ? "\n" : ",\n")
+				<< "{\"name\":\"" << event.phase->name << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << thread->thread
+				<< ",\"ts\":" << event.start / 1000.0 << ",\"dur\":" << event.duration / 1000.0 << "}";
+			first = false;
+		}
+	}
+	file << "\n]}\n";
+	return bool(file);
+}
+
+void PhaseTrace::report(std::ostream& out, double seconds)
+{
+	std::lock_guard<std::mutex> lock(registryMutex);
+	for (Phase& phase : phases()) {
+		phase.histogram.report(out, seconds);
+	}
+}
+
+void PhaseTrace::record(Phase& phase, Clock::time_point start, Clock::time_point end)
+{
+	phase.histogram.record(end - start);
+
+	if (!tracing.load(std::memory_order_acquire)) {
+		return;
+	}
+	ThreadEvents& thread = threadEvents();
+	std::lock_guard<std::mutex> lock(thread.mutex);
+	if (thread.events.size() < MAX_THREAD_EVENTS) {
+		thread.events.push_back({
+			&phase,
+			std::chrono::duration_cast<std::chrono::nanoseconds>(start - traceStart).count(),
+			std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()
+		});
+	}
+}
+
+PhaseTrace::ThreadEvents& PhaseTrace::threadEvents()
+{
+	static thread_local ThreadEvents* events = nullptr;
+	if (!events) {
+		std::lock_guard<std::mutex> lock(registryMutex);
+		threads().emplace_back(new ThreadEvents());
+		events = threads().back().get();
+		events->thread = threads().size();
+	}
+	return *events;
+}
+
+std::deque<PhaseTrace::Phase>& PhaseTrace::phases()
+{
+	static std::deque<Phase> phases;
+	return phases;
+}
+
+std::deque<std::unique_ptr<PhaseTrace::ThreadEvents>>& PhaseTrace::threads()
+{
+	static std::deque<std::unique_ptr<ThreadEvents>> threads;
+	return threads;
+}
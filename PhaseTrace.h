@@ -0,0 +1,115 @@
+#ifndef PHASETRACE_H
+#define PHASETRACE_H
+
+#include "TimingHistogram.h"
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// scoped timers around the phases of ticks and frames, 0 compiles them out
+#ifndef PHASE_TRACE
+#define PHASE_TRACE 1
+#endif
+
+// Durations of the phases of ticks and frames. Every phase has a histogram
+// for the rolling p50/p99 summary. While a trace is running, every timed
+// scope is also recorded as an event, into a buffer of its own thread, and
+// written out as Chrome trace event JSON for chrome://tracing or Perfetto.
+class PhaseTrace
+{
+public:
+	typedef std::chrono::steady_clock Clock;
+
+	class Phase
+	{
+	public:
+		explicit Phase(const char* name)
+			: name(name)
+			, histogram(name)
+		{
+		}
+
+		const char* name;
+		TimingHistogram histogram;
+	};
+
+	class Scope
+	{
+	public:
+		explicit Scope(Phase& phase)
+			: phase(phase)
+			, start(Clock::now())
+		{
+		}
+
+		Scope(const Scope& other) = delete;
+
+		Scope& operator=(const Scope& other) = delete;
+
+		~Scope()
+		{
+			record(phase, start, Clock::now());
+		}
+
+	private:
+		Phase& phase;
+		Clock::time_point start;
+	};
+
+	// the same phase for the same name, from any thread
+	static Phase& phase(const char* name);
+
+	// records events from now on
+	static void startTrace();
+
+	// the events recorded so far
+	static bool writeTrace(const std::string& path);
+
+	// prints the phases timed since the last report
+	static void report(std::ostream& out, double seconds);
+
+private:
+	struct Event
+	{
+		const Phase* phase;
+		std::int64_t start;
+		std::int64_t duration;
+	};
+
+	struct ThreadEvents
+	{
+		int thread;
+		std::mutex mutex;
+		std::vector<Event> events;
+	};
+
+	// NOTE: a bound on the memory of long traces, later events are dropped
+	static constexpr std::size_t MAX_THREAD_EVENTS = 1 << 20;
+
+	static void record(Phase& phase, Clock::time_point start, Clock::time_point end);
+
+	static ThreadEvents& threadEvents();
+
+	// NOTE: deques, phases and buffers never move
+	static std::deque<Phase>& phases();
+
+	static std::deque<std::unique_ptr<ThreadEvents>>& threads();
+};
+
+#if PHASE_TRACE
+#define PHASE_SCOPE_NAME2(name, line) name##line
+#define PHASE_SCOPE_NAME(name, line) PHASE_SCOPE_NAME2(name, line)
+#define PHASE_SCOPE(name) \
+	static PhaseTrace::Phase& PHASE_SCOPE_NAME(phase, __LINE__) = PhaseTrace::phase(name); \
+	PhaseTrace::Scope PHASE_SCOPE_NAME(phaseScope, __LINE__)(PHASE_SCOPE_NAME(phase, __LINE__))
+#else
+#define PHASE_SCOPE(name)
+#endif
+
+#endif // PHASETRACE_H
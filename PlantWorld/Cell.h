@@ -2,7 +2,6 @@
 #define PLANTWORLD_CELL_H
 
 #include "../ModuloIntDistribution.h"
-#include "../Position.h"
 
 #include <algorithm>
 
@@ -59,13 +58,6 @@ struct Plant
 		return energy >= reproductionEnergy;
 		//return true;
 	}
-
-	bool wantReproduceAt(Position p) const
-	{
-		return wantReproduce() && reproductionPosition == p;
-	}
-
-	Position reproductionPosition;
 };
 
 struct Cell
@@ -0,0 +1,157 @@
+#include "PlantBlock.h"
+
+#include <algorithm>
+
+namespace PlantWorld {
+
+namespace {
+
+const std::uint32_t bits[32] = {
+	1u << 0,  1u << 1,  1u << 2,  1u << 3,  1u << 4,  1u << 5,  1u << 6,  1u << 7,
+	1u << 8,  1u << 9,  1u << 10, 1u << 11, 1u << 12, 1u << 13, 1u << 14, 1u << 15,
+	1u << 16, 1u << 17, 1u << 18, 1u << 19, 1u << 20, 1u << 21, 1u << 22, 1u << 23,
+	1u << 24, 1u << 25, 1u << 26, 1u << 27, 1u << 28, 1u << 29, 1u << 30, 1u << 31,
+};
+
+// Energy step of 32 cells, returns the ones still alive. Branch free so it
+// vectorizes, absent cells are masked out and keep their values.
+std::uint32_t updateHalfRowEnergy(std::uint32_t present,
+	std::int32_t* __restrict energy,
+	std::int32_t* __restrict size,
+	std::int32_t* __restrict age,
+	const std::int32_t* __restrict maxSize,
+	const std::int32_t* __restrict reproductionEnergy)
+{
+	std::uint32_t alive = 0;
+	for (int c = 0; c < 32; ++c) {
+		std::int32_t p = (present & bits[c]) != 0;
+		std::int32_t e = energy[c] - p * (1 + (energy[c] >= reproductionEnergy[c]));
+		energy[c] = e;
+		size[c] += p & (size[c] < maxSize[c]);
+		age[c] += p;
+		alive |= bits[c] & (0u - std::uint32_t(e > 0));
+	}
+	return present & alive;
+}
+
+template <class T>
+void copyRow(std::vector<T>& to, const std::vector<T>& from, int row)
+{
+	std::copy(from.begin() + row * PlantBlock::COLUMNS, from.begin() + (row + 1) * PlantBlock::COLUMNS, to.begin() + row * PlantBlock::COLUMNS);
+}
+
+} // namespace
+
+PlantBlock::PlantBlock(int rows, int columns)
+	: mRows(rows)
+	, mColumns(columns)
+	, presence(ROWS, 0)
+	, energies(ROWS * COLUMNS)
+	, sizes(ROWS * COLUMNS)
+	, ages(ROWS * COLUMNS)
+	, maxSizes(ROWS * COLUMNS)
+	, reproductionEnergies(ROWS * COLUMNS)
+	, mutagenicities(ROWS * COLUMNS)
+	, reproductionDirections(ROWS * COLUMNS)
+{
+	static_assert(COLUMNS == 64, "a row's presence bits must fill one word");
+	assert(rows <= ROWS && columns <= COLUMNS);
+}
+
+int PlantBlock::plantCount() const
+{
+	int count = 0;
+	for (std::uint64_t present : presence) {
+		count += __builtin_popcountll(present);
+	}
+	return count;
+}
+
+Plant PlantBlock::plant(int index) const
+{
+	assert(hasPlant(index));
+	Plant plant;
+	plant.age = ages[index];
+	plant.energy = energies[index];
+	plant.size = sizes[index];
+	plant.maxSize = maxSizes[index];
+	plant.reproductionEnergy = reproductionEnergies[index];
+	plant.mutagenicity = mutagenicities[index];
+	return plant;
+}
+
+void PlantBlock::setPlant(int index, const Plant& plant)
+{
+	ages[index] = plant.age;
+	energies[index] = plant.energy;
+	sizes[index] = plant.size;
+	maxSizes[index] = plant.maxSize;
+	reproductionEnergies[index] = plant.reproductionEnergy;
+	mutagenicities[index] = plant.mutagenicity;
+	// NOTE: births of the parallel update may share a presence word
+	__atomic_fetch_or(&presence[index / COLUMNS], std::uint64_t(1) << (index % COLUMNS), __ATOMIC_RELAXED);
+}
+
+void PlantBlock::copyFrom(const PlantBlock& other)
+{
+	presence = other.presence;
+	energies = other.energies;
+	sizes = other.sizes;
+	ages = other.ages;
+	maxSizes = other.maxSizes;
+	reproductionEnergies = other.reproductionEnergies;
+	mutagenicities = other.mutagenicities;
+	reproductionDirections = other.reproductionDirections;
+}
+
+void PlantBlock::copyRowFrom(const PlantBlock& other, int row)
+{
+	presence[row] = other.presence[row];
+	copyRow(energies, other.energies, row);
+	copyRow(sizes, other.sizes, row);
+	copyRow(ages, other.ages, row);
+	copyRow(maxSizes, other.maxSizes, row);
+	copyRow(reproductionEnergies, other.reproductionEnergies, row);
+	copyRow(mutagenicities, other.mutagenicities, row);
+	copyRow(reproductionDirections, other.reproductionDirections, row);
+}
+
+void PlantBlock::addEnergy(int row, const std::uint8_t* grants)
+{
+	std::uint64_t present = presence[row];
+	if (present == 0) {
+		return;
+	}
+	std::int32_t* __restrict energy = &energies[row * COLUMNS];
+	for (int c = 0; c < mColumns; ++c) {
+		energy[c] += grants[c] & (0 - std::int32_t((present >> c) & 1));
+	}
+}
+
+int PlantBlock::updateEnergy()
+{
+	int diedCount = 0;
+	for (int r = 0; r < mRows; ++r) {
+		diedCount += updateEnergy(r);
+	}
+	return diedCount;
+}
+
+int PlantBlock::updateEnergy(int row)
+{
+	std::uint64_t present = presence[row];
+	if (present == 0) {
+		return 0;
+	}
+	std::uint64_t alive = 0;
+	for (int half = 0; half < 2; ++half) {
+		int i = row * COLUMNS + half * 32;
+		std::uint32_t halfAlive = updateHalfRowEnergy(std::uint32_t(present >> (half * 32)),
+			&energies[i], &sizes[i], &ages[i], &maxSizes[i], &reproductionEnergies[i]);
+		alive |= std::uint64_t(halfAlive) << (half * 32);
+	}
+	presence[row] = alive;
+	return __builtin_popcountll(present & ~alive);
+}
+
+} // namespace PlantWorld
@@ -0,0 +1,117 @@
+#ifndef PLANTWORLD_PLANTBLOCK_H
+#define PLANTWORLD_PLANTBLOCK_H
+
+#include "Cell.h"
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+namespace PlantWorld {
+
+// Structure of arrays storage of a block of cells. Cells are indexed row by
+// row with a fixed stride of COLUMNS, so the presence bits of a row are a
+// single word. Cells past rows() x columns() never hold a plant.
+class PlantBlock
+{
+public:
+	static constexpr int ROWS = 64;
+	static constexpr int COLUMNS = 64;
+
+	PlantBlock(int rows, int columns);
+
+	int rows() const
+	{
+		return mRows;
+	}
+
+	int columns() const
+	{
+		return mColumns;
+	}
+
+	static int index(int row, int col)
+	{
+		assert(row < ROWS && col < COLUMNS);
+		return row * COLUMNS + col;
+	}
+
+	bool hasPlant(int index) const
+	{
+		return (presence[index / COLUMNS] >> (index % COLUMNS)) & 1;
+	}
+
+	int plantCount() const;
+
+	Plant plant(int index) const;
+
+	void setPlant(int index, const Plant& plant);
+
+	void removePlant(int index)
+	{
+		presence[index / COLUMNS] &= ~(std::uint64_t(1) << (index % COLUMNS));
+	}
+
+	bool wantReproduce(int index) const
+	{
+		return energies[index] >= reproductionEnergies[index];
+	}
+
+	int size(int index) const
+	{
+		return sizes[index];
+	}
+
+	void addEnergy(int index, int energy)
+	{
+		if (hasPlant(index)) {
+			energies[index] += energy;
+		}
+	}
+
+	// adds grants[c] to the plant in column c of the row, if any
+	void addEnergy(int row, const std::uint8_t* grants);
+
+	int reproductionDirection(int index) const
+	{
+		return reproductionDirections[index];
+	}
+
+	void setReproductionDirection(int index, int direction)
+	{
+		assert(direction >= 0 && direction < 8);
+		reproductionDirections[index] = direction;
+	}
+
+	void copyFrom(const PlantBlock& other);
+
+	void copyRowFrom(const PlantBlock& other, int row);
+
+	// both return the plants that died
+	int updateEnergy();
+
+	int updateEnergy(int row);
+
+private:
+	int mRows;
+	int mColumns;
+
+	std::vector<std::uint64_t> presence;
+
+	// state
+	std::vector<std::int32_t> energies;
+	std::vector<std::int32_t> sizes;
+	std::vector<std::int32_t> ages;
+
+	// genes
+	std::vector<std::int32_t> maxSizes;
+	std::vector<std::int32_t> reproductionEnergies;
+	std::vector<MutagenicityGenes> mutagenicities;
+
+	// 3-bit code of the neighbor, valid while the plant wants to reproduce
+	std::vector<std::uint8_t> reproductionDirections;
+};
+
+} // namespace PlantWorld
+
+#endif // PLANTWORLD_PLANTBLOCK_H
@@ -3,60 +3,348 @@
 #include "../ModuloIntDistribution.h"
 #include "../PositionOffset.h"
 
+#include <algorithm>
 #include <cassert>
 
 #include <iostream>
 
 namespace PlantWorld {
 
+namespace {
+
+const PositionOffset reproductionOffsets[] = {
+	{-1, -1}, {-1, 0}, {-1, 1},
+	{ 0, -1},          { 0, 1},
+	{ 1, -1}, { 1, 0}, { 1, 1},
+};
+
+} // namespace
+
 PlantWorld::PlantWorld()
-	: rowCount(128)
-	, columnCount(128)
-	, initialPlantCount(rowCount * columnCount / 32)
-	, rowDistribution(0, columnCount - 1)
-	, columnDistribution(0, rowCount - 1)
-	, currentGrid(std::make_unique<Grid<Cell>>(rowCount, columnCount))
-	, updateGrid(std::make_unique<Grid<Cell>>(rowCount, columnCount))
+	: PlantWorld(128, 128)
+{
+}
+
+PlantWorld::PlantWorld(int rowCount, int columnCount)
+	: PlantWorld(rowCount, columnCount, rowCount * columnCount / 32)
+{
+}
+
+PlantWorld::PlantWorld(int rowCount, int columnCount, int initialPlantCount)
+	: rowCount(rowCount)
+	, columnCount(columnCount)
+	, initialPlantCount(initialPlantCount)
+	, plantCount(0)
+	, updateMode(UpdateMode::Fused)
+	, tick(0)
+	, rowDistribution(0, rowCount - 1)
+	, columnDistribution(0, columnCount - 1)
+	, currentBlocks(std::make_unique<PlantBlockMap>(columnCount, rowCount))
+	, updateBlocks(std::make_unique<PlantBlockMap>(columnCount, rowCount))
+	, blockStates(currentBlocks->rows() * currentBlocks->columns())
 {
 	std::random_device rd;
-	int seed = rd();
+	seed = rd();
 	random.seed(seed);
 }
 
 bool PlantWorld::initialize()
 {
 	for (int i = 0; i < initialPlantCount; ++i) {
-		Cell& cell = currentGrid->at(randomAvailablePosition());
-		cell.hasPlant = true;
-		cell.plant = randomPlant();
+		Position p = randomAvailablePosition();
+		currentBlocks->blockAt(p).setPlant(indexAt(p), randomPlant());
 	}
+	plantCount = initialPlantCount;
 
+#ifndef EVOLUTION_HEADLESS
 	renderer.initialize();
+#endif
 
 	return true;
 }
 
 void PlantWorld::update()
+{
+	switch (updateMode) {
+	case UpdateMode::MultiPass:
+		multiPassUpdate();
+		break;
+	case UpdateMode::Fused:
+		fusedUpdate();
+		break;
+	case UpdateMode::Parallel:
+		parallelUpdate();
+		break;
+	}
+
+	applyAccidents();
+
+	std::swap(updateBlocks, currentBlocks);
+	tick += 1;
+}
+
+void PlantWorld::setUpdateMode(UpdateMode mode)
+{
+	updateMode = mode;
+}
+
+void PlantWorld::setSeed(std::uint64_t seed)
+{
+	this->seed = seed;
+	random.seed(seed);
+}
+
+void PlantWorld::multiPassUpdate()
 {
 	updateCopy();
 
 	//reproduce();
 
-	updateEnergy();
+	plantCount -= updateEnergy();
 
 	reproduce();
+}
 
-	applyAccidents();
+// Performs all phases of multiPassUpdate() in a single sweep over the rows.
+// Sources of row r grant energy to rows r-1..r+1, so row r-1 is finalized
+// right after the sources of row r have been emitted. Rows R-2 and R-1 get
+// grants from the very first emitted row (R-1) and keep their own slots,
+// the remaining rows share a ring of three.
+void PlantWorld::fusedUpdate()
+{
+	if (rowCount < 3) {
+		multiPassUpdate();
+		return;
+	}
+
+	fusedGrants.assign(5 * columnCount, 0);
+
+	fusedEmitRow(rowCount - 1);
+	fusedEmitRow(0);
+	for (int r = 1; r < (rowCount - 1); ++r) {
+		if ((r + 1) < (rowCount - 2)) {
+			std::uint8_t* grants = fusedGrantRow(r + 1);
+			std::fill(grants, grants + columnCount, 0);
+		}
+		fusedEmitRow(r);
+		fusedFinalizeRow(r - 1);
+	}
+	fusedFinalizeRow(rowCount - 2);
+	fusedFinalizeRow(rowCount - 1);
+}
+
+void PlantWorld::fusedEmitRow(int rowIndex)
+{
+	for (int c = 0; c < columnCount; ++c) {
+		Position p(rowIndex, c);
+		Position energyPosition = energyPositionAt(p);
+		fusedGrantRow(energyPosition.row)[energyPosition.col] += 1;
+		setWantedReproductionPositionAt(p);
+	}
+}
+
+void PlantWorld::fusedFinalizeRow(int rowIndex)
+{
+	const std::uint8_t* grants = fusedGrantRow(rowIndex);
+	const int blockRow = rowIndex / BLOCK_ROWS;
+	const int row = rowIndex % BLOCK_ROWS;
+	for (int blockCol = 0; blockCol < currentBlocks->columns(); ++blockCol) {
+		PlantBlock& updateBlock = updateBlocks->block(blockRow, blockCol);
+		updateBlock.copyRowFrom(currentBlocks->block(blockRow, blockCol), row);
+		const int colIndex = blockCol * BLOCK_COLUMNS;
+		updateBlock.addEnergy(row, grants + colIndex);
+		plantCount -= updateBlock.updateEnergy(row);
+		for (int c = 0; c < updateBlock.columns(); ++c) {
+			if (!updateBlock.hasPlant(PlantBlock::index(row, c))) {
+				reproduceAt(Position(rowIndex, colIndex + c));
+			}
+		}
+	}
+}
+
+// Blocks are updated in parallel, each writing to its own update buffer.
+// Grants and reproduction claims crossing block borders are merged in the
+// following phase: grants are pulled from the neighbors' halos and claims
+// meet in the atomic reproduction slots.
+void PlantWorld::parallelUpdate()
+{
+	const int blockRows = currentBlocks->rows();
+	const int blockColumns = currentBlocks->columns();
+	const int blockCount = blockRows * blockColumns;
+
+	#pragma omp parallel for schedule(dynamic)
+	for (int i = 0; i < blockCount; ++i) {
+		grantBlockEnergy(i / blockColumns, i % blockColumns);
+	}
+
+	#pragma omp parallel for schedule(dynamic)
+	for (int i = 0; i < blockCount; ++i) {
+		updateBlockEnergy(i / blockColumns, i % blockColumns);
+	}
+
+	scatterReproduce();
+
+	for (const BlockState& state : blockStates) {
+		plantCount += state.plantCountChange;
+	}
+}
+
+void PlantWorld::grantBlockEnergy(int blockRow, int blockCol)
+{
+	const PlantBlock& currentBlock = currentBlocks->block(blockRow, blockCol);
+	PlantBlock& updateBlock = updateBlocks->block(blockRow, blockCol);
+	BlockState& state = blockStates[blockRow * currentBlocks->columns() + blockCol];
+
+	updateBlock.copyFrom(currentBlock);
+
+	state.grants.assign(GRANT_ROWS * GRANT_COLUMNS, 0);
+	const Position origin(blockRow * BLOCK_ROWS, blockCol * BLOCK_COLUMNS);
+	for (int r = 0; r < currentBlock.rows(); ++r) {
+		for (int c = 0; c < currentBlock.columns(); ++c) {
+			PositionOffset offset = energyOffsetAt(origin + PositionOffset(r, c));
+			state.grants[(r + 1 + offset.rowOffset) * GRANT_COLUMNS + (c + 1 + offset.colOffset)] += 1;
+		}
+	}
+}
+
+void PlantWorld::updateBlockEnergy(int blockRow, int blockCol)
+{
+	const PlantBlock& currentBlock = currentBlocks->block(blockRow, blockCol);
+	PlantBlock& updateBlock = updateBlocks->block(blockRow, blockCol);
+	BlockState& state = blockStates[blockRow * currentBlocks->columns() + blockCol];
+
+	for (int rowDirection = -1; rowDirection <= 1; ++rowDirection) {
+		for (int colDirection = -1; colDirection <= 1; ++colDirection) {
+			pullBlockGrants(blockRow, blockCol, rowDirection, colDirection);
+		}
+	}
+
+	state.plantCountChange = -updateBlock.updateEnergy();
+
+	state.reproductionClaims.clear();
+	const Position origin(blockRow * BLOCK_ROWS, blockCol * BLOCK_COLUMNS);
+	for (int r = 0; r < currentBlock.rows(); ++r) {
+		for (int c = 0; c < currentBlock.columns(); ++c) {
+			int i = PlantBlock::index(r, c);
+			if (currentBlock.hasPlant(i) && currentBlock.wantReproduce(i)) {
+				Position p = origin + PositionOffset(r, c);
+				setWantedReproductionPositionAt(p);
+				state.reproductionClaims.push_back({p, reproductionTarget(p, currentBlock.reproductionDirection(i)), 0});
+			}
+		}
+	}
+}
+
+// Adds the grants of the tile of the block in the given direction that fall
+// into this block: the interior of its own tile, the facing halo edge or the
+// halo corner of the others. The world wraps around, so with a single block
+// row or column the neighbor is the block itself.
+void PlantWorld::pullBlockGrants(int blockRow, int blockCol, int rowDirection, int colDirection)
+{
+	const int blockRows = currentBlocks->rows();
+	const int blockColumns = currentBlocks->columns();
+	PlantBlock& updateBlock = updateBlocks->block(blockRow, blockCol);
+	const int neighborRow = (blockRow + rowDirection + blockRows) % blockRows;
+	const int neighborCol = (blockCol + colDirection + blockColumns) % blockColumns;
+	const std::vector<std::uint8_t>& grants = blockStates[neighborRow * blockColumns + neighborCol].grants;
+	const PlantBlock& neighborBlock = updateBlocks->block(neighborRow, neighborCol);
+
+	int firstRow = 0;
+	int rows = updateBlock.rows();
+	int grantRow = 1;
+	if (rowDirection != 0) {
+		firstRow = (rowDirection < 0) ? 0 : rows - 1;
+		rows = 1;
+		grantRow = (rowDirection < 0) ? neighborBlock.rows() + 1 : 0;
+	}
+	int columns = updateBlock.columns();
+	int grantCol = 1;
+	int firstCol = 0;
+	if (colDirection != 0) {
+		firstCol = (colDirection < 0) ? 0 : columns - 1;
+		columns = 1;
+		grantCol = (colDirection < 0) ? neighborBlock.columns() + 1 : 0;
+	}
 
-	std::swap(updateGrid, currentGrid);
+	for (int r = 0; r < rows; ++r) {
+		const std::uint8_t* grantRowData = &grants[(grantRow + r) * GRANT_COLUMNS + grantCol];
+		if (columns == 1) {
+			updateBlock.addEnergy(PlantBlock::index(firstRow + r, firstCol), grantRowData[0]);
+		} else {
+			updateBlock.addEnergy(firstRow + r, grantRowData);
+		}
+	}
+}
+
+// Every willing plant claims its reproduction position instead of every empty
+// cell looking for willing neighbors. Slots keep the highest claimed priority,
+// which picks one claimant uniformly regardless of the order of the claims
+// and the same one as reproduceAt().
+void PlantWorld::scatterReproduce()
+{
+	if (reproductionSlots.empty()) {
+		reproductionSlots = std::vector<std::atomic<std::uint64_t>>(rowCount * columnCount);
+	}
+
+	const int blockCount = blockStates.size();
+
+	#pragma omp parallel for schedule(dynamic)
+	for (int i = 0; i < blockCount; ++i) {
+		for (ReproductionClaim& claim : blockStates[i].reproductionClaims) {
+			if (updateBlocks->blockAt(claim.target).hasPlant(indexAt(claim.target))) {
+				claim.target = Position(-1, -1);
+				continue;
+			}
+			claim.priority = reproductionPriority(claim.source);
+			std::atomic<std::uint64_t>& slot = reproductionSlots[claim.target.row * columnCount + claim.target.col];
+			std::uint64_t current = slot.load(std::memory_order_relaxed);
+			while (claim.priority > current && !slot.compare_exchange_weak(current, claim.priority, std::memory_order_relaxed)) {
+			}
+		}
+	}
+
+	#pragma omp parallel for schedule(dynamic)
+	for (int i = 0; i < blockCount; ++i) {
+		for (const ReproductionClaim& claim : blockStates[i].reproductionClaims) {
+			if (claim.target.row < 0) {
+				continue;
+			}
+			std::atomic<std::uint64_t>& slot = reproductionSlots[claim.target.row * columnCount + claim.target.col];
+			if (slot.load(std::memory_order_relaxed) == claim.priority) {
+				KeyedRandom reproductionRandom = cellRandom(ReproductionStream, claim.target);
+				Plant parent = currentBlocks->blockAt(claim.source).plant(indexAt(claim.source));
+				updateBlocks->blockAt(claim.target).setPlant(indexAt(claim.target), reproduce(parent, reproductionRandom));
+				blockStates[i].plantCountChange += 1;
+			}
+		}
+	}
+
+	#pragma omp parallel for schedule(dynamic)
+	for (int i = 0; i < blockCount; ++i) {
+		for (const ReproductionClaim& claim : blockStates[i].reproductionClaims) {
+			if (claim.target.row >= 0) {
+				reproductionSlots[claim.target.row * columnCount + claim.target.col].store(0, std::memory_order_relaxed);
+			}
+		}
+	}
+}
+
+std::uint8_t* PlantWorld::fusedGrantRow(int rowIndex)
+{
+	int slot;
+	if (rowIndex >= (rowCount - 2)) {
+		slot = 3 + rowIndex - (rowCount - 2);
+	} else {
+		slot = rowIndex % 3;
+	}
+	return &fusedGrants[slot * columnCount];
 }
 
 void PlantWorld::updateCopy()
 {
-	for (int r = 0; r < rowCount; ++r) {
-		for (int c = 0; c < columnCount; ++c) {
-			Position p(r, c);
-			updateGrid->at(p) = currentGrid->at(p);
+	for (int r = 0; r < currentBlocks->rows(); ++r) {
+		for (int c = 0; c < currentBlocks->columns(); ++c) {
+			updateBlocks->block(r, c).copyFrom(currentBlocks->block(r, c));
 		}
 	}
 }
@@ -68,123 +356,244 @@ void PlantWorld::reproduce()
 	for (int rowIndex = 0; rowIndex < rowCount; ++rowIndex) {
 		for (int colIndex = 0; colIndex < columnCount; ++colIndex) {
 			const Position globalPosition(rowIndex, colIndex);
-			Cell& updateCell = updateGrid->at(globalPosition);
-			if (updateCell.hasPlant) {
+			if (updateBlocks->blockAt(globalPosition).hasPlant(indexAt(globalPosition))) {
 				continue;
 			}
-			MooreNeighborhood<Cell, 1> mn = currentGrid->mooreNeighborhoodAt<1>(globalPosition);
-			int willingReproductorCount = 0;
-			for (int r = 0; r < 3; ++r) {
-				for (int c = 0; c < 3; ++c) {
-					const Cell& cell = mn[r][c];
-					if (cell.hasPlant) {
-						const Plant& plant = cell.plant;
-						if (plant.wantReproduceAt(globalPosition)) {
-							willingReproductorCount += 1;
-						}
-					}
-				}
-			}
-			if (willingReproductorCount == 0) {
-				continue;
-			}
-			ModuloIntDistribution<> dist(0, willingReproductorCount-1);
-			int successfulReproductorIndex = dist(random);
-			int willingReproductorIndex = 0;
-			for (int r = 0; r < 3; ++r) {
-				for (int c = 0; c < 3; ++c) {
-					const Cell& cell = mn[r][c];
-					if (cell.hasPlant) {
-						const Plant& plant = cell.plant;
-						if (plant.wantReproduceAt(globalPosition)) {
-							if (successfulReproductorIndex == willingReproductorIndex) {
-								updateCell.hasPlant = true;
-								updateCell.plant = reproduce(plant);
-								//initialPlantCount += 1;
-								//std::cout << "reproduce: " << initialPlantCount << std::endl;
-								goto nextCell;
-							}
-							willingReproductorIndex += 1;
-						}
-					}
+			reproduceAt(globalPosition);
+		}
+	}
+}
+
+void PlantWorld::reproduceAt(Position position)
+{
+	bool willingReproductorFound = false;
+	Position successfulReproductor;
+	std::uint64_t successfulPriority = 0;
+	for (int r = -1; r <= 1; ++r) {
+		for (int c = -1; c <= 1; ++c) {
+			Position source = wraparound(position + PositionOffset(r, c));
+			const PlantBlock& block = currentBlocks->blockAt(source);
+			int i = indexAt(source);
+			if (block.hasPlant(i) && block.wantReproduce(i) && reproductionTarget(source, block.reproductionDirection(i)) == position) {
+				std::uint64_t priority = reproductionPriority(source);
+				if (!willingReproductorFound || priority > successfulPriority) {
+					willingReproductorFound = true;
+					successfulReproductor = source;
+					successfulPriority = priority;
 				}
 			}
-			nextCell:;
 		}
 	}
+	if (!willingReproductorFound) {
+		return;
+	}
+	KeyedRandom reproductionRandom = cellRandom(ReproductionStream, position);
+	Plant parent = currentBlocks->blockAt(successfulReproductor).plant(indexAt(successfulReproductor));
+	updateBlocks->blockAt(position).setPlant(indexAt(position), reproduce(parent, reproductionRandom));
+	plantCount += 1;
+	//initialPlantCount += 1;
+	//std::cout << "reproduce: " << initialPlantCount << std::endl;
+}
+
+// Random priority in the high half, cell index as the tie-break in the low half.
+std::uint64_t PlantWorld::reproductionPriority(Position source) const
+{
+	KeyedRandom priorityRandom = cellRandom(ReproductionPriorityStream, source);
+	return (std::uint64_t(priorityRandom()) << 32) | std::uint32_t(source.row * columnCount + source.col);
+}
+
+Position PlantWorld::reproductionTarget(Position source, int direction) const
+{
+	return wraparound(source + reproductionOffsets[direction]);
+}
+
+int PlantWorld::indexAt(Position position)
+{
+	Position local = PlantBlockMap::localPosition(position);
+	return PlantBlock::index(local.row, local.col);
 }
 
 void PlantWorld::setWantedReproductionPositions()
 {
 	for (int r = 0; r < rowCount; ++r) {
 		for (int c = 0; c < columnCount; ++c) {
-			Position p(r, c);
-			Cell& cell = currentGrid->at(p);
-			if (cell.hasPlant) {
-				Plant& plant  = cell.plant;
-				if (plant.wantReproduce()) {
-					plant.reproductionPosition = randomNearbyWraparoundedPosition(p);
-				}
-			}
+			setWantedReproductionPositionAt(Position(r, c));
 		}
 	}
 }
 
-void PlantWorld::updateEnergy()
+void PlantWorld::setWantedReproductionPositionAt(Position position)
+{
+	PlantBlock& block = currentBlocks->blockAt(position);
+	int i = indexAt(position);
+	if (block.hasPlant(i) && block.wantReproduce(i)) {
+		KeyedRandom positionRandom = cellRandom(ReproductionPositionStream, position);
+		ModuloIntDistribution<> directionDistribution(0, 7);
+		block.setReproductionDirection(i, directionDistribution(positionRandom));
+	}
+}
+
+// returns the plants that died
+int PlantWorld::updateEnergy()
 {
 	addRandomEnergyBySize();
 
-	for (int r = 0; r < rowCount; ++r) {
-		for (int c = 0; c < columnCount; ++c) {
-			Position p(r, c);
-			Cell& cell = updateGrid->at(p);
-			if (cell.hasPlant) {
-				Plant& plant  = cell.plant;
-				plant.energy -= (1 + plant.wantReproduce());
-				if (plant.energy <= 0) {
-					cell.hasPlant = false;
-					//initialPlantCount -= 1;
-					//std::cout << "death: " << initialPlantCount << std::endl;
-				} else {
-					if (plant.size < plant.maxSize) {
-						plant.size += 1;
-					}
-					plant.age += 1;
-				}
-			}
+	int diedCount = 0;
+	for (int r = 0; r < updateBlocks->rows(); ++r) {
+		for (int c = 0; c < updateBlocks->columns(); ++c) {
+			diedCount += updateBlocks->block(r, c).updateEnergy();
 		}
 	}
 	//std::cout << "count: " << initialPlantCount << std::endl;
+	return diedCount;
 }
 
 void PlantWorld::addRandomEnergyBySize()
 {
 	for (int r = 0; r < rowCount; ++r) {
 		for (int c = 0; c < columnCount; ++c) {
-			Position p(r, c);
-			MooreNeighborhood<Cell, 1> mn = currentGrid->mooreNeighborhoodAt<1>(p);
-			Position energyPosition = p + (randomPositionBySize(mn) - Position(1, 1));
-			energyPosition = wraparound(energyPosition);
-			Cell& updateCell = updateGrid->at(energyPosition);
-			if (updateCell.hasPlant) {
-				updateCell.plant.energy += 1;
+			Position energyPosition = energyPositionAt(Position(r, c));
+			updateBlocks->blockAt(energyPosition).addEnergy(indexAt(energyPosition), 1);
+		}
+	}
+}
+
+PositionOffset PlantWorld::energyOffsetAt(Position position) const
+{
+	MooreNeighborhood<int, 1> sizes;
+	const PlantBlock& block = currentBlocks->blockAt(position);
+	const Position local = PlantBlockMap::localPosition(position);
+	if (local.row > 0 && local.col > 0 && local.row < (block.rows() - 1) && local.col < (block.columns() - 1)) {
+		for (int r = 0; r < 3; ++r) {
+			for (int c = 0; c < 3; ++c) {
+				int i = PlantBlock::index(local.row + r - 1, local.col + c - 1);
+				sizes[r][c] = block.hasPlant(i) ? block.size(i) : 0;
+			}
+		}
+	} else {
+		for (int r = 0; r < 3; ++r) {
+			for (int c = 0; c < 3; ++c) {
+				Position p = wraparound(position + PositionOffset(r - 1, c - 1));
+				const PlantBlock& nearbyBlock = currentBlocks->blockAt(p);
+				int i = indexAt(p);
+				sizes[r][c] = nearbyBlock.hasPlant(i) ? nearbyBlock.size(i) : 0;
 			}
 		}
 	}
+	KeyedRandom energyRandom = cellRandom(EnergyStream, position);
+	return randomPositionBySize(sizes, energyRandom) - Position(1, 1);
+}
+
+Position PlantWorld::energyPositionAt(Position position) const
+{
+	return wraparound(position + energyOffsetAt(position));
 }
 
 void PlantWorld::applyAccidents()
 {
 	for (int i = 0; i < 10; ++i) {
 		Position position = randomPosition();
-		Cell& cell = updateGrid->at(position);
-		cell.hasPlant = false;
+		PlantBlock& block = updateBlocks->blockAt(position);
+		int index = indexAt(position);
+		if (block.hasPlant(index)) {
+			block.removePlant(index);
+			plantCount -= 1;
+		}
 	}
 }
 
+KeyedRandom PlantWorld::cellRandom(RandomStream stream, Position position) const
+{
+	return KeyedRandom(seed, tick, stream, position.row, position.col);
+}
+
+void PlantWorld::snapshot()
+{
+#ifndef EVOLUTION_HEADLESS
+	renderer.snapshot(*this);
+#endif
+}
+
+void PlantWorld::analyze()
+{
+	statistics.collect(*this);
+}
+
 void PlantWorld::render() const
 {
-	renderer.render(*this);
+#ifndef EVOLUTION_HEADLESS
+	renderer.render();
+#endif
+}
+
+// NOTE: plants get redder with age up to 255 ticks, the renderer colors them
+// by their age relative to the median age instead
+bool PlantWorld::rasterize(Frame& frame) const
+{
+	frame.resize(rowCount, columnCount);
+	const PlantBlockMap* blocks = currentBlocks.get();
+
+	#pragma omp parallel for schedule(dynamic)
+	for (int r = 0; r < rowCount; ++r) {
+		for (int c = 0; c < columnCount; ++c) {
+			const Position p(r, c);
+			const PlantBlock& block = blocks->blockAt(p);
+			int i = indexAt(p);
+			if (block.hasPlant(i)) {
+				frame.setPixel(r, c, std::uint8_t(std::min(block.plant(i).age, 255)), 255, 0);
+			} else {
+				frame.setPixel(r, c, 0, 0, 0);
+			}
+		}
+	}
+
+	return true;
+}
+
+void PlantWorld::setViewport(const Viewport& viewport)
+{
+#ifndef EVOLUTION_HEADLESS
+	renderer.setViewport(viewport);
+#endif
+}
+
+int PlantWorld::cellCount() const
+{
+	return rowCount * columnCount;
+}
+
+int PlantWorld::organismCount() const
+{
+	return plantCount;
+}
+
+std::uint64_t PlantWorld::digest() const
+{
+	std::uint64_t hash = 0;
+	auto combine = [&hash](std::uint64_t value) {
+		hash ^= value + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+	};
+	for (int r = 0; r < rowCount; ++r) {
+		for (int c = 0; c < columnCount; ++c) {
+			const Position p(r, c);
+			const PlantBlock& block = currentBlocks->blockAt(p);
+			int i = indexAt(p);
+			if (!block.hasPlant(i)) {
+				continue;
+			}
+			Plant plant = block.plant(i);
+			combine(r * std::uint64_t(columnCount) + c);
+			combine(plant.age);
+			combine(plant.energy);
+			combine(plant.size);
+			combine(plant.maxSize);
+			combine(plant.reproductionEnergy);
+			combine(plant.mutagenicity.stabilityFactor);
+			combine(plant.mutagenicity.incrementFactor);
+			combine(plant.mutagenicity.decrementFactor);
+		}
+	}
+	return hash;
 }
 
 Plant PlantWorld::randomPlant() const
@@ -201,14 +610,14 @@ Plant PlantWorld::randomPlant() const
 	return plant;
 }
 
-Plant PlantWorld::reproduce(const Plant &parent) const
+Plant PlantWorld::reproduce(const Plant &parent, KeyedRandom& cellRandom) const
 {
 	Plant child;
 	child.energy = 1;
 	child.size = 1;
-	child.maxSize = std::max(parent.maxSize + parent.mutagenicity.generate(random), 1);
-	child.reproductionEnergy = std::max(parent.reproductionEnergy + parent.mutagenicity.generate(random), 1);
-	child.mutagenicity = parent.mutagenicity.selfMutated(random);
+	child.maxSize = std::max(parent.maxSize + parent.mutagenicity.generate(cellRandom), 1);
+	child.reproductionEnergy = std::max(parent.reproductionEnergy + parent.mutagenicity.generate(cellRandom), 1);
+	child.mutagenicity = parent.mutagenicity.selfMutated(cellRandom);
 
 	return child;
 }
@@ -223,32 +632,28 @@ Position PlantWorld::randomAvailablePosition() const
 	Position p;
 	do {
 		p = randomPosition();
-	} while (currentGrid->at(p).hasPlant);
+	} while (currentBlocks->blockAt(p).hasPlant(indexAt(p)));
 	return p;
 }
 
-Position PlantWorld::randomPositionBySize(const MooreNeighborhood<Cell, 1>& mn) const
+Position PlantWorld::randomPositionBySize(const MooreNeighborhood<int, 1>& sizes, KeyedRandom& cellRandom) const
 {
 	int sum = 0;
 	for (int r = 0; r < 3; ++r) {
 		for (int c = 0; c < 3; ++c) {
-			const Cell& cell = mn[r][c];
-			if (cell.hasPlant) {
-				sum += cell.plant.size;
-			}
+			sum += sizes[r][c];
 		}
 	}
 	if (sum == 0) {
 		return Position(1, 1);
 	}
 	ModuloIntDistribution<> dist(0, sum-1);
-	int number = dist(random);
+	int number = dist(cellRandom);
 	sum = 0;
 	for (int r = 0; r < 3; ++r) {
 		for (int c = 0; c < 3; ++c) {
-			const Cell& cell = mn[r][c];
-			if (cell.hasPlant) {
-				sum += cell.plant.size;
+			if (sizes[r][c] > 0) {
+				sum += sizes[r][c];
 				if (number <= sum) {
 					return Position(r, c);
 				}
@@ -259,25 +664,6 @@ Position PlantWorld::randomPositionBySize(const MooreNeighborhood<Cell, 1>& mn)
 	return Position(1, 1);
 }
 
-Position PlantWorld::randomNearbyPosition(Position position) const
-{
-	const PositionOffset offsets[] = {
-		{-1, -1}, {-1, 0}, {-1, 1},
-		{ 0, -1},          { 0, 1},
-		{ 1, -1}, { 1, 0}, { 1, 1},
-	};
-	ModuloIntDistribution<> positionOffsetDistribution(0, 7);
-	PositionOffset offset = offsets[positionOffsetDistribution(random)];
-	Position nearbyPosition = position + offset;
-	assert(nearbyPosition != position);
-	return nearbyPosition;
-}
-
-Position PlantWorld::randomNearbyWraparoundedPosition(Position position) const
-{
-	return wraparound(randomNearbyPosition(position));
-}
-
 Position PlantWorld::wraparound(Position position) const
 {
 	while (position.row < 0) {
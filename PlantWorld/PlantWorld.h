@@ -3,16 +3,26 @@
 
 
 #include "Cell.h"
+#include "PlantBlock.h"
+#include "PlantWorldStatistics.h"
 
+#include "../BlockMap.h"
 #include "../Grid.h"
+#include "../KeyedRandom.h"
 #include "../ModuloIntDistribution.h"
 #include "../Position.h"
+#include "../PositionOffset.h"
 #include "../Simulation.h"
 
+#ifndef EVOLUTION_HEADLESS
 #include "PlantWorldRenderer.h"
+#endif
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
 #include <random>
+#include <vector>
 
 namespace PlantWorld {
 
@@ -20,41 +30,138 @@ class PlantWorld final : public Simulation
 {
 public:
 
+	enum class UpdateMode
+	{
+		MultiPass,
+		Fused,
+		Parallel,
+	};
+
 	PlantWorld();
 
+	PlantWorld(int rowCount, int columnCount);
+
+	PlantWorld(int rowCount, int columnCount, int initialPlantCount);
+
 	virtual bool initialize() override;
 
 	virtual void update() override;
 
+	virtual void snapshot() override;
+
+	virtual void analyze() override;
+
 	virtual void render() const override;
 
+	virtual bool rasterize(Frame& frame) const override;
+
+	virtual void setViewport(const Viewport& viewport) override;
+
+	virtual int cellCount() const override;
+
+	virtual int organismCount() const override;
+
+	void setUpdateMode(UpdateMode mode);
+
+	// before initialize(), the world is the same in every update mode
+	void setSeed(std::uint64_t seed);
+
+	// hash of all the plants, equal worlds have equal digests
+	std::uint64_t digest() const;
+
 private:
 
+	static constexpr int BLOCK_ROWS = PlantBlock::ROWS;
+	static constexpr int BLOCK_COLUMNS = PlantBlock::COLUMNS;
+
+	typedef BlockMap<Cell, BLOCK_ROWS, BLOCK_COLUMNS, PlantBlock> PlantBlockMap;
+
+	enum RandomStream
+	{
+		EnergyStream,
+		ReproductionPositionStream,
+		ReproductionPriorityStream,
+		ReproductionStream,
+	};
+
+	struct ReproductionClaim
+	{
+		Position source;
+		Position target;
+		std::uint64_t priority;
+	};
+
+	static constexpr int GRANT_ROWS = BLOCK_ROWS + 2;
+	static constexpr int GRANT_COLUMNS = BLOCK_COLUMNS + 2;
+
+	// Written by the block's own task only. Grants are counted in a tile with
+	// a one cell halo, the halo holds the grants entering the neighbors and is
+	// pulled by them once all blocks are done granting.
+	struct BlockState
+	{
+		std::vector<std::uint8_t> grants;
+		std::vector<ReproductionClaim> reproductionClaims;
+		// births of its claims less deaths in the block, of the tick
+		int plantCountChange;
+	};
+
+	void multiPassUpdate();
+
+	void fusedUpdate();
+
+	void parallelUpdate();
+
+	void grantBlockEnergy(int blockRow, int blockCol);
+
+	void updateBlockEnergy(int blockRow, int blockCol);
+
+	void pullBlockGrants(int blockRow, int blockCol, int rowDirection, int colDirection);
+
+	void scatterReproduce();
+
+	void fusedEmitRow(int rowIndex);
+
+	void fusedFinalizeRow(int rowIndex);
+
+	std::uint8_t* fusedGrantRow(int rowIndex);
+
 	void updateCopy();
 
 	void reproduce();
 
 	void setWantedReproductionPositions();
 
-	void updateEnergy();
+	int updateEnergy();
 
 	void addRandomEnergyBySize();
 
 	void applyAccidents();
 
+	PositionOffset energyOffsetAt(Position position) const;
+
+	Position energyPositionAt(Position position) const;
+
+	void setWantedReproductionPositionAt(Position position);
+
+	void reproduceAt(Position position);
+
+	std::uint64_t reproductionPriority(Position source) const;
+
+	Position reproductionTarget(Position source, int direction) const;
+
+	static int indexAt(Position position);
+
+	KeyedRandom cellRandom(RandomStream stream, Position position) const;
+
 	Plant randomPlant() const;
 
-	Plant reproduce(const Plant &parent) const;
+	Plant reproduce(const Plant &parent, KeyedRandom& cellRandom) const;
 
 	Position randomPosition() const;
 
 	Position randomAvailablePosition() const;
 
-	Position randomPositionBySize(const MooreNeighborhood<Cell, 1>& mn) const;
-
-	Position randomNearbyPosition(Position position) const;
-
-	Position randomNearbyWraparoundedPosition(Position position) const;
+	Position randomPositionBySize(const MooreNeighborhood<int, 1>& sizes, KeyedRandom& cellRandom) const;
 
 	Position wraparound(Position position) const;
 
@@ -65,15 +172,37 @@ private:
 
 	int initialPlantCount;
 
+	// kept up to date with every birth and death
+	int plantCount;
+
+	UpdateMode updateMode;
+
+	std::uint64_t seed;
+	std::uint64_t tick;
+
 	mutable std::minstd_rand0 random; // NOTE: fastest from std
 	mutable ModuloIntDistribution<> rowDistribution;
 	mutable ModuloIntDistribution<> columnDistribution;
 
-	std::unique_ptr<Grid<Cell>> currentGrid;
-	std::unique_ptr<Grid<Cell>> updateGrid;
+	std::unique_ptr<PlantBlockMap> currentBlocks;
+	std::unique_ptr<PlantBlockMap> updateBlocks;
+
+	// energy grants of the rows inside the fused sweep window
+	std::vector<std::uint8_t> fusedGrants;
+
+	std::vector<BlockState> blockStates;
+
+	// per-cell slots the willing reproductors of the parallel update compete
+	// for, a slot holds the highest priority claimed so far
+	std::vector<std::atomic<std::uint64_t>> reproductionSlots;
+
+	friend class PlantWorldStatistics;
+	PlantWorldStatistics statistics;
 
+#ifndef EVOLUTION_HEADLESS
 	friend class PlantWorldRenderer;
 	PlantWorldRenderer renderer;
+#endif
 };
 
 } // namespace PlantWorld
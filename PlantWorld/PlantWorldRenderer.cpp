@@ -5,8 +5,6 @@
 #include <algorithm>
 #include <cstddef>
 
-#include <iostream>
-
 namespace PlantWorld {
 
 PlantWorldRenderer::PlantWorldRenderer()
@@ -17,8 +15,20 @@ void PlantWorldRenderer::initialize()
 {
 	initializeShaders();
 
-	instanceVertexBufferObject = VertexBufferObject::generate();
+#if PLANTWORLD_RENDER_USE_TEXTURE
+	cellTexture = Texture::generate();
+
+	// the area the instances cover
+	GLfloat quadVertices[] = {
+		-0.955f,  0.955f,
+		0.955f, -0.955f,
+		-0.955f, -0.955f,
 
+		-0.955f,  0.955f,
+		0.955f, -0.955f,
+		0.955f,  0.955f,
+	};
+#else
 	GLfloat quadVertices[] = {
 		-0.005f,  0.005f,
 		0.005f, -0.005f,
@@ -28,6 +38,7 @@ void PlantWorldRenderer::initialize()
 		0.005f, -0.005f,
 		0.005f,  0.005f,
 	};
+#endif
 
 	quadVertexArrayObject = VertexArrayObject::generate();
 	quadVertexBufferObject = VertexBufferObject::generate();
@@ -37,109 +48,228 @@ void PlantWorldRenderer::initialize()
 	glEnableVertexAttribArray(0);
 	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(GLfloat), (GLvoid*)0);
 
-	instanceVertexBufferObject.bind();
-	glEnableVertexAttribArray(1);
-	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Quad), (GLvoid*)offsetof(Quad, position));
-	glVertexAttribDivisor(1, 1);
-	glEnableVertexAttribArray(2);
-	glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Quad), (GLvoid*)offsetof(Quad, color));
-	glVertexAttribDivisor(2, 1);
-	instanceVertexBufferObject.unbind();
-
 	quadVertexArrayObject.unbind();
 }
 
+#if PLANTWORLD_RENDER_USE_TEXTURE
+
+// NOTE: column 0 is on the right and row 0 on the top, like the instances.
+// The visible part of the world wraps around.
 void PlantWorldRenderer::initializeShaders()
 {
 	VertexShader vertexShader(
 		"#version 330 core\n"
 		"layout (location = 0) in vec2 position;\n"
-		"layout (location = 1) in vec2 offset;\n"
-		"layout (location = 2) in vec3 color;\n"
-		"out vec3 fColor;\n"
+		"out vec2 fPosition;\n"
 		"void main()\n"
 		"{\n"
-		"	gl_Position = vec4(position + offset, 0.0f, 1.0f);\n"
-		"	fColor = color;\n"
+		"	gl_Position = vec4(position, 0.0f, 1.0f);\n"
+		"	fPosition = position;\n"
 		"}\n"
 	);
 	FragmentShader fragmentShader(
 		"#version 330 core\n"
-		"in vec3 fColor;\n"
+		"uniform usampler2D cells;\n"
+		"uniform float medianAge;\n"
+		"uniform vec3 viewport;\n"
+		"in vec2 fPosition;\n"
 		"out vec4 color;\n"
 		"void main()\n"
 		"{\n"
-		"	color = vec4(fColor, 1.0f);\n"
+		"	vec2 visible = (0.955f - fPosition) / 1.91f;\n"
+		"	vec2 world = fract(viewport.xy + (visible - 0.5f) / viewport.z);\n"
+		"	ivec2 size = textureSize(cells, 0);\n"
+		"	ivec2 cell = min(ivec2(world * vec2(size)), size - 1);\n"
+		"	uint age = texelFetch(cells, cell, 0).r;\n"
+		"	if (age == 0u) {\n"
+		"		color = vec4(0.0f, 0.0f, 0.0f, 1.0f);\n"
+		"	} else {\n"
+		"		float red = min((float(age - 1u) - medianAge + 128.0f) / 256.0f, 1.0f);\n"
+		"		color = vec4(red, 1.0f, 0.0f, 1.0f);\n"
+		"	}\n"
 		"}\n"
 	);
 
 	program = ShaderProgram(vertexShader, fragmentShader);
+	medianAgeLocation = program.uniformLocation("medianAge");
+	viewportLocation = program.uniformLocation("viewport");
 }
 
-void PlantWorldRenderer::render(const PlantWorld& world) const
+void PlantWorldRenderer::setViewport(const Viewport& viewport)
 {
-	quads.clear();
-	energies.clear();
-	ages.clear();
-	sizes.clear();
-	maxSizes.clear();
+	this->viewport = viewport;
+}
 
-	const Grid<Cell>* grid = world.currentGrid.get();
+void PlantWorldRenderer::snapshot(const PlantWorld& world)
+{
+	if (!snapshots.isConsumed()) {
+		return;
+	}
+
+	Snapshot& snapshot = snapshots.back();
+	const PlantWorld::PlantBlockMap* blocks = world.currentBlocks.get();
 	int rowCount = world.rowCount;
 	int columnCount = world.columnCount;
+	image.resize(rowCount, columnCount);
+	snapshot.ages.clear();
 
+	std::uint16_t* cells = image.texels();
 	for (int r = 0; r < rowCount; ++ r) {
 		for (int c = 0; c < columnCount; ++c) {
-			const Cell& cell = grid->at(r, c);
-			if (cell.hasPlant) {
-				energies.push_back(cell.plant.energy);
-				ages.push_back(cell.plant.age);
-				sizes.push_back(cell.plant.size);
-				maxSizes.push_back(cell.plant.maxSize);
+			const Position p(r, c);
+			const PlantBlock& block = blocks->blockAt(p);
+			int i = PlantWorld::indexAt(p);
+			if (block.hasPlant(i)) {
+				Plant plant = block.plant(i);
+				*cells++ = std::min(plant.age + 1, 0xffff);
+				snapshot.ages.push_back(plant.age);
+			} else {
+				*cells++ = 0;
 			}
 		}
 	}
 
-	int medianAge;
-	if (!ages.empty()) {
-		int i = ages.size()/2;
-		std::nth_element(ages.begin(), ages.begin() + i, ages.end());
-		medianAge = ages[i];
+	image.pack(snapshot.cells);
+	snapshots.publish();
+}
+
+void PlantWorldRenderer::render() const
+{
+	program.use();
+	if (snapshots.update()) {
+		const Snapshot& snapshot = snapshots.front();
+
+		medianAges = snapshot.ages;
+		int medianAge = 0;
+		if (!medianAges.empty()) {
+			int i = medianAges.size()/2;
+			std::nth_element(medianAges.begin(), medianAges.begin() + i, medianAges.end());
+			medianAge = medianAges[i];
+		}
+		glUniform1f(medianAgeLocation, medianAge);
+
+		cellTexture.setImage<std::uint16_t>(GL_R16UI, GL_RED_INTEGER, GL_UNSIGNED_SHORT, snapshot.cells);
 	}
+	glUniform3f(viewportLocation, viewport.centerX, viewport.centerY, viewport.zoom);
+	cellTexture.bind();
+	quadVertexArrayObject.bind();
+	glDrawArrays(GL_TRIANGLES, 0, 6);
+	quadVertexArrayObject.unbind();
+	Texture::unbind();
+}
+
+#else // PLANTWORLD_RENDER_USE_TEXTURE
+
+// NOTE: the instances always cover the whole world
+void PlantWorldRenderer::setViewport(const Viewport& /*viewport*/)
+{
+}
+
+void PlantWorldRenderer::initializeShaders()
+{
+	VertexShader vertexShader(
+		"#version 330 core\n"
+		"layout (location = 0) in vec2 position;\n"
+		"layout (location = 1) in vec2 offset;\n"
+		"layout (location = 2) in vec3 color;\n"
+		"out vec3 fColor;\n"
+		"void main()\n"
+		"{\n"
+		"	gl_Position = vec4(position + offset, 0.0f, 1.0f);\n"
+		"	fColor = color;\n"
+		"}\n"
+	);
+	FragmentShader fragmentShader(
+		"#version 330 core\n"
+		"in vec3 fColor;\n"
+		"out vec4 color;\n"
+		"void main()\n"
+		"{\n"
+		"	color = vec4(fColor, 1.0f);\n"
+		"}\n"
+	);
+
+	program = ShaderProgram(vertexShader, fragmentShader);
+}
+
+// NOTE: every new snapshot is written to another region, a grown buffer is
+// another buffer object
+void PlantWorldRenderer::setInstanceAttributes() const
+{
+	GLintptr offset = instanceBuffer.offset();
+	instanceBuffer.bind();
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Quad), (GLvoid*)(offset + offsetof(Quad, position)));
+	glVertexAttribDivisor(1, 1);
+	glEnableVertexAttribArray(2);
+	glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Quad), (GLvoid*)(offset + offsetof(Quad, color)));
+	glVertexAttribDivisor(2, 1);
+	VertexBufferObject::unbind();
+}
+
+void PlantWorldRenderer::snapshot(const PlantWorld& world)
+{
+	if (!snapshots.isConsumed()) {
+		return;
+	}
+
+	Snapshot& snapshot = snapshots.back();
+	snapshot.quads.clear();
+	snapshot.ages.clear();
+
+	const PlantWorld::PlantBlockMap* blocks = world.currentBlocks.get();
+	int rowCount = world.rowCount;
+	int columnCount = world.columnCount;
 
 	for (int r = 0; r < rowCount; ++ r) {
 		GLfloat y = 0.95f - GLfloat(1.90 * r) / rowCount;
 		for (int c = 0; c < columnCount; ++c) {
 			GLfloat x = 0.95f - GLfloat(1.90 * c) / columnCount;
-			const Cell& cell = grid->at(r, c);
-			if (cell.hasPlant) {
-				quads.push_back({{x, y}, {std::min((cell.plant.age - medianAge + 128) / 256.0f, 1.0f), 1.0f, 0.0f}});
+			const Position p(r, c);
+			const PlantBlock& block = blocks->blockAt(p);
+			int i = PlantWorld::indexAt(p);
+			if (block.hasPlant(i)) {
+				Plant plant = block.plant(i);
+				snapshot.quads.push_back({{x, y}, {0.0f, 1.0f, 0.0f}});
+				snapshot.ages.push_back(plant.age);
 			}
 		}
 	}
 
+	snapshots.publish();
+}
+
+void PlantWorldRenderer::render() const
+{
 	program.use();
 	quadVertexArrayObject.bind();
-	instanceVertexBufferObject.setData(quads, GL_DYNAMIC_DRAW);
-	glDrawArraysInstanced(GL_TRIANGLES, 0, 6, quads.size());
-	quadVertexArrayObject.unbind();
+	if (snapshots.update()) {
+		Snapshot& snapshot = snapshots.front();
 
-	std::cout << "energy:   " << medianElement(energies) << std::endl;
-	std::cout << "age:      " << medianElement(ages) << std::endl;
-	std::cout << "sizes:    " << medianElement(sizes) << std::endl;
-	std::cout << "maxSizes: " << medianElement(maxSizes) << std::endl;
-}
+		medianAges = snapshot.ages;
+		int medianAge = 0;
+		if (!medianAges.empty()) {
+			int i = medianAges.size()/2;
+			std::nth_element(medianAges.begin(), medianAges.begin() + i, medianAges.end());
+			medianAge = medianAges[i];
+		}
 
-std::string PlantWorldRenderer::medianElement(std::vector<int>& v, std::string empty) const
-{
-	if (v.empty()) {
-		return empty;
-	} else {
-		// NOTE: fuck evens
-		int i = v.size()/2;
-		std::nth_element(v.begin(), v.begin() + i, v.end());
-		return std::to_string(v[i]);
+		Quad* quads = instanceBuffer.map(snapshot.quads.size());
+		for (std::size_t i = 0; i < snapshot.quads.size(); ++i) {
+			// NOTE: mapped memory is only written, never read back
+			Quad quad = snapshot.quads[i];
+			quad.color.x = std::min((snapshot.ages[i] - medianAge + 128) / 256.0f, 1.0f);
+			quads[i] = quad;
+		}
+		instanceBuffer.unmap();
+		setInstanceAttributes();
 	}
+
+	glDrawArraysInstanced(GL_TRIANGLES, 0, 6, instanceBuffer.count());
+	instanceBuffer.fence();
+	quadVertexArrayObject.unbind();
 }
 
+#endif // PLANTWORLD_RENDER_USE_TEXTURE
+
 } // namespace PlantWorld
@@ -3,13 +3,21 @@
 
 #include "../Buffer.h"
 #include "../Shader.h"
+#include "../Texture.h"
+#include "../TripleBuffer.h"
 #include "../VertexArrayObject.h"
+#include "../Viewport.h"
 
 #include <glm/vec2.hpp>
 #include <glm/vec3.hpp>
 
+#include <cstdint>
 #include <vector>
 
+// plant ages as a two byte texture colored by the fragment shader, instead
+// of a 20 byte instance per plant
+#define PLANTWORLD_RENDER_USE_TEXTURE 1
+
 namespace PlantWorld {
 
 class PlantWorld;
@@ -22,32 +30,61 @@ class PlantWorldRenderer
 		glm::vec3 color;
 	};
 
+#if PLANTWORLD_RENDER_USE_TEXTURE
+	// changes of the age + 1 of the plant in every cell, 0 for no plant, and
+	// the ages of all plants for the median
+	struct Snapshot
+	{
+		TiledImage<std::uint16_t>::Changes cells;
+		std::vector<int> ages;
+	};
+#else
+	// plants in the order of quads, colors are set once the median age is known
+	struct Snapshot
+	{
+		std::vector<Quad> quads;
+		std::vector<int> ages;
+	};
+#endif
+
 public:
 
 	PlantWorldRenderer();
 
 	void initialize();
 
-	void render(const PlantWorld& world) const;
+	void snapshot(const PlantWorld& world);
+
+	void render() const;
+
+	void setViewport(const Viewport& viewport);
 
 private:
 
 	void initializeShaders();
 
-	std::string medianElement(std::vector<int>& v, std::string empty = "-") const;
+#if !PLANTWORLD_RENDER_USE_TEXTURE
+	void setInstanceAttributes() const;
+#endif
 
 private:
 
 	ShaderProgram program;
-	VertexBufferObject instanceVertexBufferObject;
 	VertexArrayObject quadVertexArrayObject;
 	VertexBufferObject quadVertexBufferObject;
 
-	mutable std::vector<Quad> quads;
-	mutable std::vector<int> energies;
-	mutable std::vector<int> ages;
-	mutable std::vector<int> sizes;
-	mutable std::vector<int> maxSizes;
+#if PLANTWORLD_RENDER_USE_TEXTURE
+	GLint medianAgeLocation;
+	GLint viewportLocation;
+	Viewport viewport;
+	mutable Texture cellTexture;
+	// only written by snapshot()
+	TiledImage<std::uint16_t> image;
+#else
+	mutable StreamingVertexBuffer<Quad> instanceBuffer;
+#endif
+	mutable TripleBuffer<Snapshot> snapshots;
+	mutable std::vector<int> medianAges;
 };
 
 } // namespace PlantWorld
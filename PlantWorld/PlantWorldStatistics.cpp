@@ -0,0 +1,85 @@
+#include "PlantWorldStatistics.h"
+
+#include "PlantWorld.h"
+
+#include <algorithm>
+#include <iostream>
+
+namespace PlantWorld {
+
+PlantWorldStatistics::PlantWorldStatistics()
+	: pipeline(&PlantWorldStatistics::analyze)
+{
+}
+
+void PlantWorldStatistics::collect(const PlantWorld& world)
+{
+	Sample* sample = pipeline.acquire();
+	if (!sample) {
+		return;
+	}
+
+	sample->droppedCount = pipeline.droppedCount();
+
+	const PlantWorld::PlantBlockMap& blocks = *world.currentBlocks;
+	std::size_t blockCount = std::size_t(blocks.rows()) * blocks.columns();
+	if (sample->blocks.size() != blockCount) {
+		sample->blocks.clear();
+		sample->blocks.reserve(blockCount);
+		for (int r = 0; r < blocks.rows(); ++r) {
+			for (int c = 0; c < blocks.columns(); ++c) {
+				sample->blocks.push_back(blocks.block(r, c));
+			}
+		}
+	} else {
+		for (int r = 0; r < blocks.rows(); ++r) {
+			for (int c = 0; c < blocks.columns(); ++c) {
+				sample->blocks[std::size_t(r) * blocks.columns() + c].copyFrom(blocks.block(r, c));
+			}
+		}
+	}
+
+	pipeline.submit();
+}
+
+void PlantWorldStatistics::analyze(Sample& sample)
+{
+	sample.energies.clear();
+	sample.ages.clear();
+	sample.sizes.clear();
+	sample.maxSizes.clear();
+	for (const PlantBlock& block : sample.blocks) {
+		for (int r = 0; r < block.rows(); ++r) {
+			for (int c = 0; c < block.columns(); ++c) {
+				int i = PlantBlock::index(r, c);
+				if (block.hasPlant(i)) {
+					Plant plant = block.plant(i);
+					sample.energies.push_back(plant.energy);
+					sample.ages.push_back(plant.age);
+					sample.sizes.push_back(plant.size);
+					sample.maxSizes.push_back(plant.maxSize);
+				}
+			}
+		}
+	}
+
+	std::cout << "energy:   " << medianElement(sample.energies) << std::endl;
+	std::cout << "age:      " << medianElement(sample.ages) << std::endl;
+	std::cout << "sizes:    " << medianElement(sample.sizes) << std::endl;
+	std::cout << "maxSizes: " << medianElement(sample.maxSizes) << std::endl;
+	std::cout << "dropped samples: " << sample.droppedCount << std::endl;
+}
+
+std::string PlantWorldStatistics::medianElement(std::vector<int>& v, std::string empty)
+{
+	if (v.empty()) {
+		return empty;
+	} else {
+		// NOTE: fuck evens
+		int i = v.size()/2;
+		std::nth_element(v.begin(), v.begin() + i, v.end());
+		return std::to_string(v[i]);
+	}
+}
+
+} // namespace PlantWorld
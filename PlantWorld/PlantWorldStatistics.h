@@ -0,0 +1,48 @@
+#ifndef PLANTWORLD_PLANTWORLDSTATISTICS_H
+#define PLANTWORLD_PLANTWORLDSTATISTICS_H
+
+#include "PlantBlock.h"
+
+#include "../AnalysisPipeline.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace PlantWorld {
+
+class PlantWorld;
+
+// Plants of one tick, the medians are found and printed on the analysis
+// thread. The simulation thread only copies the blocks, the analysis thread
+// walks their cells.
+class PlantWorldStatistics
+{
+	struct Sample
+	{
+		std::vector<PlantBlock> blocks;
+		std::vector<int> energies;
+		std::vector<int> ages;
+		std::vector<int> sizes;
+		std::vector<int> maxSizes;
+		std::uint64_t droppedCount;
+	};
+
+public:
+
+	PlantWorldStatistics();
+
+	void collect(const PlantWorld& world);
+
+private:
+
+	static void analyze(Sample& sample);
+
+	static std::string medianElement(std::vector<int>& v, std::string empty = "-");
+
+	AnalysisPipeline<Sample> pipeline;
+};
+
+} // namespace PlantWorld
+
+#endif // PLANTWORLD_PLANTWORLDSTATISTICS_H
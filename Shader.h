@@ -135,6 +135,11 @@ public:
 		glUseProgram(index);
 	}
 
+	GLint uniformLocation(const GLchar* name) const
+	{
+		return glGetUniformLocation(index, name);
+	}
+
 private:
 	GLuint index;
 };
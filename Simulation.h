@@ -1,6 +1,14 @@
 #ifndef SIMULATION_H
 #define SIMULATION_H
 
+#include "Frame.h"
+#include "Viewport.h"
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
 class Simulation
 {
 public:
@@ -10,7 +18,59 @@ public:
 
 	virtual void update() = 0;
 
+	// Called on the simulation thread between updates, copies what render()
+	// needs so that render() can run on another thread concurrently with
+	// update().
+	virtual void snapshot() = 0;
+
+	// Called on the simulation thread between updates, at most about once a
+	// second, hands the statistics of the tick to an analysis thread.
+	// Samples are dropped while the analysis is behind.
+	virtual void analyze()
+	{
+	}
+
+	// Names of the values recorded every tick, empty for worlds without
+	// telemetry.
+	virtual std::vector<std::string> telemetryColumns() const
+	{
+		return {};
+	}
+
+	// Called on the simulation thread while telemetry is recorded, once
+	// before the first update and after every update. Writes one value per
+	// column, events are counted since the previous call.
+	virtual void telemetry(std::int32_t* /*values*/)
+	{
+	}
+
+	// Writes the ancestry of the organisms alive as CSV. Returns false for
+	// worlds without lineages, failures of the stream are left to the caller.
+	virtual bool writePhylogeny(std::ostream& /*out*/)
+	{
+		return false;
+	}
+
 	virtual void render() const = 0;
+
+	// Draws the world into the frame without OpenGL, for capturing headless
+	// runs. Returns false for worlds that cannot be captured.
+	virtual bool rasterize(Frame& /*frame*/) const
+	{
+		return false;
+	}
+
+	// Called on the render thread whenever the visible part of the world
+	// changes.
+	virtual void setViewport(const Viewport& /*viewport*/)
+	{
+	}
+
+	virtual int cellCount() const = 0;
+
+	// organisms alive, kept up to date by the updates so that counting does
+	// not touch the cells
+	virtual int organismCount() const = 0;
 };
 
 #endif // SIMULATION_H
@@ -0,0 +1,77 @@
+#include "SweepRunner.h"
+
+#include "Arena.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+SweepRunner::SweepRunner(int rows, int columns, int tickCount, int threadCount)
+	: rows(rows)
+	, columns(columns)
+	, tickCount(tickCount)
+	, threadCount(threadCount)
+{
+}
+
+std::vector<SweepRunner::Result> SweepRunner::run(const std::vector<Run>& runs) const
+{
+	std::vector<Result> results(runs.size());
+	std::atomic<std::size_t> nextRun(0);
+
+	auto work = [&]() {
+		Arena arena;
+		Arena::Scope scope(arena);
+		for (std::size_t i = nextRun++; i < runs.size(); i = nextRun++) {
+			results[i] = runWorld(runs[i]);
+			arena.reset();
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for (int i = 1; i < threadCount; ++i) {
+		threads.emplace_back(work);
+	}
+	work();
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+
+	return results;
+}
+
+SweepRunner::Result SweepRunner::runWorld(const Run& run) const
+{
+	auto start = std::chrono::steady_clock::now();
+
+	GridWorld world(rows, columns, run.population);
+	world.setSeed(run.seed);
+	world.setAccidentCount(run.accidentCount);
+	world.initialize();
+	for (int i = 0; i < tickCount; ++i) {
+		world.update();
+	}
+
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	return {run, world.population(), elapsed.count()};
+}
+
+void SweepRunner::writeSummary(std::ostream& out, const std::vector<Result>& results) const
+{
+	out << "run,rows,columns,ticks,population,accidents,seed,plants,herbivores,carnivores,seconds,ticks_per_second" << std::endl;
+	for (std::size_t i = 0; i < results.size(); ++i) {
+		const Result& result = results[i];
+		out << i << ","
+			<< rows << ","
+			<< columns << ","
+			<< tickCount << ","
+			<< result.run.population << ","
+			<< result.run.accidentCount << ","
+			<< result.run.seed << ","
+			<< result.population.plants << ","
+			<< result.population.herbivores << ","
+			<< result.population.carnivores << ","
+			<< result.seconds << ","
+			<< (result.seconds > 0 ? tickCount / result.seconds : 0) << std::endl;
+	}
+}
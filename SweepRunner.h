@@ -0,0 +1,44 @@
+#ifndef SWEEPRUNNER_H
+#define SWEEPRUNNER_H
+
+#include "GridWorld/GridWorld.h"
+
+#include <ostream>
+#include <vector>
+
+// Runs independent headless GridWorlds on a pool of threads. Every thread
+// takes the next run from a shared counter and allocates the world's cells
+// from its own arena, which is reset between runs.
+class SweepRunner
+{
+public:
+	struct Run
+	{
+		int population;
+		int accidentCount;
+		unsigned seed;
+	};
+
+	struct Result
+	{
+		Run run;
+		GridWorld::Population population;
+		double seconds;
+	};
+
+	SweepRunner(int rows, int columns, int tickCount, int threadCount);
+
+	std::vector<Result> run(const std::vector<Run>& runs) const;
+
+	void writeSummary(std::ostream& out, const std::vector<Result>& results) const;
+
+private:
+	Result runWorld(const Run& run) const;
+
+	int rows;
+	int columns;
+	int tickCount;
+	int threadCount;
+};
+
+#endif // SWEEPRUNNER_H
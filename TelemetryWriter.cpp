@@ -0,0 +1,115 @@
+#include "TelemetryWriter.h"
+
+#include "PhaseTrace.h"
+
+#include <iostream>
+
+constexpr std::uint64_t TelemetryWriter::MAGIC;
+constexpr std::uint32_t TelemetryWriter::VERSION;
+constexpr int TelemetryWriter::CHUNK_ROWS;
+
+namespace {
+
+template <class T>
+void append(std::vector<char>& buffer, const T& value)
+{
+	const char* bytes = reinterpret_cast<const char*>(&value);
+	buffer.insert(buffer.end(), bytes, bytes + sizeof(value));
+}
+
+} // namespace
+
+TelemetryWriter::TelemetryWriter(const std::string& path, std::vector<std::string> columns)
+	: path(path)
+	, columns(std::move(columns))
+	, row(this->columns.size())
+	, chunk(nullptr)
+	, mDroppedCount(0)
+	, mWrittenCount(0)
+	, failed(false)
+	, pipeline([this](Chunk& chunk) { write(chunk); }, 4)
+{
+}
+
+// NOTE: the world is asked every tick even while chunks are dropped, its
+// events are counted since the previous call. Rows are filled as they come
+// and made columns on the writer thread.
+void TelemetryWriter::record(Simulation& world, std::uint64_t tick)
+{
+	PHASE_SCOPE("telemetry");
+	if (!chunk) {
+		chunk = pipeline.acquire();
+		if (chunk) {
+			chunk->firstTick = tick;
+			chunk->rowCount = 0;
+			chunk->values.resize(columns.size() * CHUNK_ROWS);
+		}
+	}
+	if (!chunk) {
+		world.telemetry(row.data());
+		mDroppedCount += 1;
+		return;
+	}
+
+	world.telemetry(chunk->values.data() + chunk->rowCount * columns.size());
+	chunk->rowCount += 1;
+	if (chunk->rowCount == CHUNK_ROWS) {
+		pipeline.submit();
+		chunk = nullptr;
+	}
+}
+
+void TelemetryWriter::finish()
+{
+	if (chunk) {
+		pipeline.submit();
+		chunk = nullptr;
+	}
+	pipeline.finish();
+	stream.flush();
+}
+
+// NOTE: a failed write is reported once, later chunks are not written
+void TelemetryWriter::write(const Chunk& chunk)
+{
+	if (failed) {
+		return;
+	}
+	if (!stream.is_open() && !writeHeader()) {
+		std::cout << "Writing telemetry to " << path << " failed" << std::endl;
+		failed = true;
+		return;
+	}
+
+	buffer.clear();
+	append(buffer, chunk.firstTick);
+	append(buffer, std::uint32_t(chunk.rowCount));
+	for (std::size_t c = 0; c < columns.size(); ++c) {
+		for (int r = 0; r < chunk.rowCount; ++r) {
+			append(buffer, chunk.values[r * columns.size() + c]);
+		}
+	}
+	stream.write(buffer.data(), buffer.size());
+	if (!stream) {
+		std::cout << "Writing telemetry of tick " << chunk.firstTick << " to " << path << " failed" << std::endl;
+		failed = true;
+		return;
+	}
+	mWrittenCount += chunk.rowCount;
+}
+
+bool TelemetryWriter::writeHeader()
+{
+	stream.open(path, std::ios::binary);
+
+	buffer.clear();
+	append(buffer, MAGIC);
+	append(buffer, VERSION);
+	append(buffer, std::uint32_t(columns.size()));
+	for (const std::string& column : columns) {
+		append(buffer, std::uint16_t(column.size()));
+		buffer.insert(buffer.end(), column.begin(), column.end());
+	}
+	stream.write(buffer.data(), buffer.size());
+	return bool(stream);
+}
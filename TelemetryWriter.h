@@ -0,0 +1,81 @@
+#ifndef TELEMETRYWRITER_H
+#define TELEMETRYWRITER_H
+
+#include "AnalysisPipeline.h"
+#include "Simulation.h"
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Records the telemetry of a world every tick into a columnar binary file.
+// The simulation thread fills chunks of CHUNK_ROWS ticks row by row, a
+// background thread turns every full chunk into columns and writes it with
+// one large write. Chunks are dropped while the writer is behind.
+//
+// The file, in native byte order:
+//   header: u64 MAGIC, u32 VERSION, u32 column count,
+//           per column a u16 name length and the name
+//   chunks: u64 first tick, u32 row count,
+//           per column row count i32 values of consecutive ticks
+class TelemetryWriter
+{
+public:
+	static constexpr std::uint64_t MAGIC = 0x4d454c45544f5645; // "EVOTELEM"
+	static constexpr std::uint32_t VERSION = 1;
+
+	static constexpr int CHUNK_ROWS = 4096;
+
+	TelemetryWriter(const std::string& path, std::vector<std::string> columns);
+
+	// the values of the world at the tick
+	void record(Simulation& world, std::uint64_t tick);
+
+	// writes the ticks still queued
+	void finish();
+
+	std::uint64_t writtenCount() const
+	{
+		return mWrittenCount;
+	}
+
+	// ticks
+	std::uint64_t droppedCount() const
+	{
+		return mDroppedCount;
+	}
+
+private:
+	struct Chunk
+	{
+		std::uint64_t firstTick;
+		int rowCount;
+		// row by row
+		std::vector<std::int32_t> values;
+	};
+
+	void write(const Chunk& chunk);
+
+	bool writeHeader();
+
+private:
+	std::string path;
+	std::vector<std::string> columns;
+
+	// only used by the simulation thread, the values of dropped ticks
+	std::vector<std::int32_t> row;
+	Chunk* chunk;
+	std::uint64_t mDroppedCount;
+
+	// only used by the writer thread
+	std::vector<char> buffer;
+	std::ofstream stream;
+	std::uint64_t mWrittenCount;
+	bool failed;
+
+	// NOTE: last, its worker uses the members above
+	AnalysisPipeline<Chunk> pipeline;
+};
+
+#endif // TELEMETRYWRITER_H
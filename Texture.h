@@ -0,0 +1,113 @@
+#ifndef TEXTURE_H
+#define TEXTURE_H
+
+#include "TiledImage.h"
+
+#include <GL/glew.h>
+
+#include <cstddef>
+#include <utility>
+
+// 2D texture read with texelFetch, one texel per cell, so there is no
+// filtering and no mipmaps.
+class Texture
+{
+public:
+	Texture()
+		: index(0)
+		, width(0)
+		, height(0)
+	{
+	}
+
+	explicit Texture(GLuint index)
+		: index(index)
+		, width(0)
+		, height(0)
+	{
+	}
+
+	Texture(const Texture& other) = delete;
+
+	Texture(Texture&& other)
+		: index(other.index)
+		, width(other.width)
+		, height(other.height)
+	{
+		other.index = 0;
+	}
+
+	Texture& operator=(const Texture& other) = delete;
+
+	// NOTE: the texture held so far goes to other, which deletes it
+	Texture& operator=(Texture&& other)
+	{
+		std::swap(index, other.index);
+		width = other.width;
+		height = other.height;
+		return *this;
+	}
+
+	~Texture()
+	{
+		glDeleteTextures(1, &index);
+	}
+
+	static Texture generate()
+	{
+		GLuint index;
+		glGenTextures(1, &index);
+		Texture texture(index);
+		texture.bind();
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		unbind();
+		return texture;
+	}
+
+	void bind() const
+	{
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, index);
+	}
+
+	static void unbind()
+	{
+		glBindTexture(GL_TEXTURE_2D, 0);
+	}
+
+	// the rectangles changed since the last upload, the storage is only
+	// allocated when the size changes
+	template <class T>
+	void setImage(GLint internalFormat, GLenum format, GLenum type, const typename TiledImage<T>::Changes& changes)
+	{
+		bind();
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		if (changes.columns != width || changes.rows != height) {
+			glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, changes.columns, changes.rows, 0, format, type, nullptr);
+			width = changes.columns;
+			height = changes.rows;
+		}
+		for (const auto& rectangle : changes.rectangles) {
+			glTexSubImage2D(GL_TEXTURE_2D, 0, rectangle.column, rectangle.row, rectangle.columns, rectangle.rows,
+				format, type, &changes.texels[rectangle.offset]);
+		}
+		uploadedByteCount() += changes.texels.size() * sizeof(T);
+	}
+
+	// texel bytes uploaded by all textures so far, counted on the render thread
+	static std::size_t& uploadedByteCount()
+	{
+		static std::size_t count = 0;
+		return count;
+	}
+
+private:
+	GLuint index;
+	GLsizei width;
+	GLsizei height;
+};
+
+#endif // TEXTURE_H
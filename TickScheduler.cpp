@@ -0,0 +1,53 @@
+#include "TickScheduler.h"
+
+#include <thread>
+
+TickScheduler::TickScheduler()
+	: mMode(Mode::MaxThroughput)
+	, tickPeriod(Clock::duration::zero())
+	, framePeriod(Clock::duration::zero())
+{
+}
+
+void TickScheduler::setMaxThroughput()
+{
+	mMode = Mode::MaxThroughput;
+}
+
+void TickScheduler::setTickRate(double ticksPerSecond)
+{
+	mMode = Mode::FixedTickRate;
+	tickPeriod = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / ticksPerSecond));
+}
+
+void TickScheduler::setFrameRate(double framesPerSecond)
+{
+	mMode = Mode::FixedFrameRate;
+	framePeriod = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / framesPerSecond));
+}
+
+void TickScheduler::waitForTick()
+{
+	if (mMode == Mode::FixedTickRate) {
+		waitUntil(nextTick, tickPeriod);
+	}
+}
+
+void TickScheduler::waitForFrame()
+{
+	if (mMode == Mode::FixedFrameRate) {
+		waitUntil(nextFrame, framePeriod);
+	}
+}
+
+// Keeps a steady rate, but a thread that fell more than a period behind
+// starts over from now instead of catching up in a burst.
+void TickScheduler::waitUntil(Clock::time_point& next, Clock::duration period)
+{
+	Clock::time_point now = Clock::now();
+	if (next < now - period) {
+		next = now;
+	}
+	std::this_thread::sleep_until(next);
+	next += period;
+}
@@ -0,0 +1,51 @@
+#ifndef TICKSCHEDULER_H
+#define TICKSCHEDULER_H
+
+#include <chrono>
+
+// Paces the simulation and the render thread. Waiting always sleeps, the
+// threads never spin.
+class TickScheduler
+{
+public:
+	enum class Mode
+	{
+		MaxThroughput,  // ticks back to back, frames at the display rate
+		FixedTickRate,  // ticks at tickRate, frames at the display rate
+		FixedFrameRate, // frames at frameRate, as many ticks as fit between them
+	};
+
+	TickScheduler();
+
+	void setMaxThroughput();
+
+	void setTickRate(double ticksPerSecond);
+
+	void setFrameRate(double framesPerSecond);
+
+	Mode mode() const
+	{
+		return mMode;
+	}
+
+	// called by the simulation thread before every tick
+	void waitForTick();
+
+	// called by the render thread before every frame
+	void waitForFrame();
+
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	static void waitUntil(Clock::time_point& next, Clock::duration period);
+
+	Mode mMode;
+
+	Clock::duration tickPeriod;
+	Clock::duration framePeriod;
+
+	Clock::time_point nextTick;
+	Clock::time_point nextFrame;
+};
+
+#endif // TICKSCHEDULER_H
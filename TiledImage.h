@@ -0,0 +1,122 @@
+#ifndef TILEDIMAGE_H
+#define TILEDIMAGE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+// One texel per cell, rewritten in full by every snapshot on the simulation
+// thread. pack() compares it tile by tile with the previous snapshot and
+// copies out only the changed tiles, the render thread then updates just
+// those parts of the texture. Neighboring changed tiles of a tile row are
+// merged into one rectangle to keep the number of uploads down.
+template <class T>
+class TiledImage
+{
+public:
+	static constexpr int TILE_SIZE = 64;
+
+	// texels of the rectangle are packed row after row from offset
+	struct Rectangle
+	{
+		int row;
+		int column;
+		int rows;
+		int columns;
+		std::size_t offset;
+	};
+
+	struct Changes
+	{
+		int rows;
+		int columns;
+		std::vector<Rectangle> rectangles;
+		std::vector<T> texels;
+	};
+
+	TiledImage()
+		: rowCount(0)
+		, columnCount(0)
+		, changedAll(false)
+	{
+	}
+
+	// a new size marks everything as changed
+	void resize(int rows, int columns)
+	{
+		if (rows != rowCount || columns != columnCount) {
+			rowCount = rows;
+			columnCount = columns;
+			current.assign(rows * columns, T());
+			previous.assign(rows * columns, T());
+			changedAll = true;
+		}
+	}
+
+	T* texels()
+	{
+		return current.data();
+	}
+
+	void pack(Changes& changes)
+	{
+		changes.rows = rowCount;
+		changes.columns = columnCount;
+		changes.rectangles.clear();
+		changes.texels.clear();
+
+		int tileColumns = (columnCount + TILE_SIZE - 1) / TILE_SIZE;
+		for (int row = 0; row < rowCount; row += TILE_SIZE) {
+			int rows = std::min(TILE_SIZE, rowCount - row);
+			int first = -1;
+			for (int tileColumn = 0; tileColumn <= tileColumns; ++tileColumn) {
+				int column = tileColumn * TILE_SIZE;
+				bool changed = tileColumn < tileColumns && (changedAll || isChanged(row, rows, column));
+				if (changed && first < 0) {
+					first = column;
+				} else if (!changed && first >= 0) {
+					copy(changes, row, rows, first, std::min(column, columnCount));
+					first = -1;
+				}
+			}
+		}
+		changedAll = false;
+	}
+
+private:
+	bool isChanged(int row, int rows, int column) const
+	{
+		int columns = std::min(TILE_SIZE, columnCount - column);
+		for (int r = row; r < (row + rows); ++r) {
+			std::size_t i = std::size_t(r) * columnCount + column;
+			if (std::memcmp(&current[i], &previous[i], columns * sizeof(T)) != 0) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void copy(Changes& changes, int row, int rows, int column, int end)
+	{
+		int columns = end - column;
+		changes.rectangles.push_back({row, column, rows, columns, changes.texels.size()});
+		for (int r = row; r < (row + rows); ++r) {
+			std::size_t i = std::size_t(r) * columnCount + column;
+			changes.texels.insert(changes.texels.end(), &current[i], &current[i] + columns);
+			std::copy(&current[i], &current[i] + columns, &previous[i]);
+		}
+	}
+
+	int rowCount;
+	int columnCount;
+	bool changedAll;
+
+	std::vector<T> current;
+	std::vector<T> previous;
+};
+
+template <class T>
+constexpr int TiledImage<T>::TILE_SIZE;
+
+#endif // TILEDIMAGE_H
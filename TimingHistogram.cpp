@@ -0,0 +1,65 @@
+#include "TimingHistogram.h"
+
+#include <algorithm>
+#include <iomanip>
+
+TimingHistogram::TimingHistogram(std::string name)
+	: name(std::move(name))
+	, maxMicroseconds(0)
+{
+	for (auto& bucket : buckets) {
+		bucket.store(0, std::memory_order_relaxed);
+	}
+}
+
+void TimingHistogram::record(std::chrono::steady_clock::duration duration)
+{
+	std::uint64_t microseconds = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+	int bucket = 0;
+	while (bucket < (BUCKET_COUNT - 1) && microseconds >= bucketLimit(bucket)) {
+		++bucket;
+	}
+	buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+
+	std::uint64_t max = maxMicroseconds.load(std::memory_order_relaxed);
+	while (microseconds > max && !maxMicroseconds.compare_exchange_weak(max, microseconds, std::memory_order_relaxed)) {
+	}
+}
+
+void TimingHistogram::report(std::ostream& out, double seconds)
+{
+	std::array<std::uint64_t, BUCKET_COUNT> counts;
+	std::uint64_t count = 0;
+	for (int i = 0; i < BUCKET_COUNT; ++i) {
+		counts[i] = buckets[i].exchange(0, std::memory_order_relaxed);
+		count += counts[i];
+	}
+	std::uint64_t max = maxMicroseconds.exchange(0, std::memory_order_relaxed);
+
+	// upper bound of the bucket holding the given fraction of the samples
+	auto percentile = [&](double fraction) {
+		std::uint64_t rank = std::uint64_t(fraction * (count - 1)) + 1;
+		std::uint64_t sum = 0;
+		for (int i = 0; i < BUCKET_COUNT; ++i) {
+			sum += counts[i];
+			if (sum >= rank) {
+				return std::min(bucketLimit(i), max);
+			}
+		}
+		return max;
+	};
+
+	out << std::left << std::setw(11) << name << std::right
+		<< std::setw(8) << count << " " << std::setw(8) << std::fixed << std::setprecision(1) << count / seconds << "/s";
+	if (count > 0) {
+		out << "  p50<=" << percentile(0.50) << "us"
+			<< "  p99<=" << percentile(0.99) << "us"
+			<< "  max=" << max << "us";
+	}
+	out << std::defaultfloat << std::endl;
+}
+
+std::uint64_t TimingHistogram::bucketLimit(int bucket)
+{
+	return std::uint64_t(1) << bucket;
+}
@@ -0,0 +1,34 @@
+#ifndef TIMINGHISTOGRAM_H
+#define TIMINGHISTOGRAM_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+// Histogram of durations in power of two microsecond buckets. record() may
+// be called from one thread while another one reports, reporting resets it.
+class TimingHistogram
+{
+public:
+	explicit TimingHistogram(std::string name);
+
+	void record(std::chrono::steady_clock::duration duration);
+
+	// prints count, rate, p50, p99 and max since the last report
+	void report(std::ostream& out, double seconds);
+
+private:
+	static constexpr int BUCKET_COUNT = 32;
+
+	static std::uint64_t bucketLimit(int bucket);
+
+	std::string name;
+
+	std::array<std::atomic<std::uint64_t>, BUCKET_COUNT> buckets;
+	std::atomic<std::uint64_t> maxMicroseconds;
+};
+
+#endif // TIMINGHISTOGRAM_H
@@ -0,0 +1,29 @@
+#ifndef TRANSPORT_H
+#define TRANSPORT_H
+
+#include <cstddef>
+
+// Ordered, reliable byte streams between a domain and its neighbors. Up is the
+// domain owning the rows above, Down the one owning the rows below, both
+// wrapping around like the world does.
+class Transport
+{
+public:
+	enum class Direction
+	{
+		Up,
+		Down,
+	};
+
+	virtual ~Transport()
+	{
+	}
+
+	// blocks until all bytes are sent, false when the link is broken
+	virtual bool send(Direction direction, const void* data, std::size_t size) = 0;
+
+	// blocks until all bytes are received, false when the link is broken
+	virtual bool receive(Direction direction, void* data, std::size_t size) = 0;
+};
+
+#endif // TRANSPORT_H
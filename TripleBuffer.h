@@ -0,0 +1,78 @@
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// Lock-free single producer, single consumer triple buffer. The writer fills
+// back() and publishes it, the reader picks up the latest published buffer
+// with update() and keeps reading front() until the next update(). Neither
+// side ever waits, intermediate buffers the reader did not pick up are
+// overwritten.
+template <class T>
+class TripleBuffer
+{
+public:
+	TripleBuffer()
+		: backIndex(0)
+		, frontIndex(1)
+		, middle(2)
+	{
+	}
+
+	TripleBuffer(const TripleBuffer& other) = delete;
+
+	TripleBuffer& operator=(const TripleBuffer& other) = delete;
+
+	// writer
+
+	T& back()
+	{
+		return buffers[backIndex];
+	}
+
+	void publish()
+	{
+		backIndex = middle.exchange(backIndex | FRESH, std::memory_order_acq_rel) & INDEX;
+	}
+
+	// true once the reader has taken the last published buffer
+	bool isConsumed() const
+	{
+		return !(middle.load(std::memory_order_acquire) & FRESH);
+	}
+
+	// reader
+
+	bool update()
+	{
+		if (!(middle.load(std::memory_order_relaxed) & FRESH)) {
+			return false;
+		}
+		frontIndex = middle.exchange(frontIndex, std::memory_order_acq_rel) & INDEX;
+		return true;
+	}
+
+	T& front()
+	{
+		return buffers[frontIndex];
+	}
+
+	const T& front() const
+	{
+		return buffers[frontIndex];
+	}
+
+private:
+	static constexpr std::uint8_t INDEX = 0x3;
+	static constexpr std::uint8_t FRESH = 0x4;
+
+	std::array<T, 3> buffers;
+
+	std::uint8_t backIndex;
+	std::uint8_t frontIndex;
+	std::atomic<std::uint8_t> middle;
+};
+
+#endif // TRIPLEBUFFER_H
@@ -0,0 +1,68 @@
+#include "UnixSocketTransport.h"
+
+#include <cerrno>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+bool UnixSocketTransport::createLinks(int domainCount, std::vector<int>& sockets)
+{
+	sockets.assign(domainCount * 2, -1);
+	for (int i = 0; i < domainCount; ++i) {
+		if (::socketpair(AF_UNIX, SOCK_STREAM, 0, &sockets[i * 2]) != 0) {
+			return false;
+		}
+	}
+	return true;
+}
+
+UnixSocketTransport::UnixSocketTransport(int domain, int domainCount, const std::vector<int>& sockets)
+	: upSocket(sockets[((domain + domainCount - 1) % domainCount) * 2 + 1])
+	, downSocket(sockets[domain * 2])
+{
+	for (int socket : sockets) {
+		if (socket != upSocket && socket != downSocket) {
+			::close(socket);
+		}
+	}
+}
+
+UnixSocketTransport::~UnixSocketTransport()
+{
+	::close(upSocket);
+	::close(downSocket);
+}
+
+bool UnixSocketTransport::send(Direction direction, const void* data, std::size_t size)
+{
+	const char* bytes = static_cast<const char*>(data);
+	while (size > 0) {
+		ssize_t count = ::send(socket(direction), bytes, size, MSG_NOSIGNAL);
+		if (count < 0 && errno == EINTR) {
+			continue;
+		}
+		if (count <= 0) {
+			return false;
+		}
+		bytes += count;
+		size -= count;
+	}
+	return true;
+}
+
+bool UnixSocketTransport::receive(Direction direction, void* data, std::size_t size)
+{
+	char* bytes = static_cast<char*>(data);
+	while (size > 0) {
+		ssize_t count = ::recv(socket(direction), bytes, size, 0);
+		if (count < 0 && errno == EINTR) {
+			continue;
+		}
+		if (count <= 0) {
+			return false;
+		}
+		bytes += count;
+		size -= count;
+	}
+	return true;
+}
@@ -0,0 +1,40 @@
+#ifndef UNIXSOCKETTRANSPORT_H
+#define UNIXSOCKETTRANSPORT_H
+
+#include "Transport.h"
+
+#include <vector>
+
+// Transport between forked processes. All the socket pairs of the ring are
+// created by the parent before forking, then every process keeps the ends of
+// its own two links and closes the rest.
+class UnixSocketTransport final : public Transport
+{
+public:
+	// link i connects domain i and domain (i + 1) % domainCount
+	static bool createLinks(int domainCount, std::vector<int>& sockets);
+
+	// takes the ends of the domain's links and closes all others
+	UnixSocketTransport(int domain, int domainCount, const std::vector<int>& sockets);
+
+	~UnixSocketTransport();
+
+	UnixSocketTransport(const UnixSocketTransport&) = delete;
+
+	UnixSocketTransport& operator=(const UnixSocketTransport&) = delete;
+
+	virtual bool send(Direction direction, const void* data, std::size_t size) override;
+
+	virtual bool receive(Direction direction, void* data, std::size_t size) override;
+
+private:
+	int socket(Direction direction) const
+	{
+		return direction == Direction::Up ? upSocket : downSocket;
+	}
+
+	int upSocket;
+	int downSocket;
+};
+
+#endif // UNIXSOCKETTRANSPORT_H
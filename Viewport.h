@@ -0,0 +1,51 @@
+#ifndef VIEWPORT_H
+#define VIEWPORT_H
+
+#include <algorithm>
+#include <cmath>
+
+// The part of the world on the screen. The center is a fraction of the world
+// size, a zoom of 1 shows the whole world. The world wraps around, so does
+// panning.
+struct Viewport
+{
+	float centerX = 0.5f;
+	float centerY = 0.5f;
+	float zoom = 1.0f;
+
+	// pixels of the screen area the world is drawn to
+	int width = 764;
+	int height = 573;
+
+	// by fractions of the visible part
+	void pan(float columns, float rows)
+	{
+		centerX = wrap(centerX + columns / zoom);
+		centerY = wrap(centerY + rows / zoom);
+	}
+
+	void zoomBy(float factor)
+	{
+		zoom = std::min(std::max(zoom * factor, 1.0f), 4096.0f);
+	}
+
+	// Level of detail of a world of the given size: tiles of 2^level cells
+	// on a side are the smallest that are still a pixel or more.
+	int level(int rows, int columns) const
+	{
+		float cellsPerPixel = std::max(columns / zoom / width, rows / zoom / height);
+		int level = 0;
+		while (float(1 << level) < cellsPerPixel) {
+			++level;
+		}
+		return level;
+	}
+
+private:
+	static float wrap(float fraction)
+	{
+		return fraction - std::floor(fraction);
+	}
+};
+
+#endif // VIEWPORT_H
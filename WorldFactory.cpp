@@ -0,0 +1,78 @@
+#include "WorldFactory.h"
+
+#include "GameOfLife/GameOfLifeWorld.h"
+#include "GridWorld/GridWorld.h"
+#include "PlantWorld/PlantWorld.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+bool parseWorldOption(int argc, char* argv[], int& i, WorldSettings& settings)
+{
+	if ((i + 1) >= argc) {
+		return false;
+	}
+	if (std::strcmp(argv[i], "--world") == 0) {
+		settings.name = argv[++i];
+	} else if (std::strcmp(argv[i], "--rows") == 0) {
+		settings.rows = std::atoi(argv[++i]);
+	} else if (std::strcmp(argv[i], "--columns") == 0) {
+		settings.columns = std::atoi(argv[++i]);
+	} else if (std::strcmp(argv[i], "--population") == 0) {
+		settings.population = std::atoi(argv[++i]);
+	} else if (std::strcmp(argv[i], "--plant-mode") == 0) {
+		settings.plantMode = argv[++i];
+	} else {
+		return false;
+	}
+	return true;
+}
+
+const char* worldOptionsUsage()
+{
+	return "[--world grid|gameoflife|plant] [--rows <n>] [--columns <n>] [--population <n>]"
+		" [--plant-mode multipass|fused|parallel]";
+}
+
+std::unique_ptr<Simulation> createWorld(const WorldSettings& settings)
+{
+	if (settings.rows <= 0 || settings.columns <= 0) {
+		return nullptr;
+	}
+	// NOTE: worlds place their population on free cells
+	const int population = int(std::min<std::int64_t>(settings.population, std::int64_t(settings.rows) * settings.columns));
+	const bool defaultPopulation = settings.population < 0;
+
+	if (settings.name == "grid") {
+		if (defaultPopulation) {
+			return std::make_unique<GridWorld>(settings.rows, settings.columns);
+		}
+		return std::make_unique<GridWorld>(settings.rows, settings.columns, population);
+	}
+	if (settings.name == "gameoflife") {
+		if (defaultPopulation) {
+			return std::make_unique<GameOfLife::GameOfLifeWorld>(settings.rows, settings.columns);
+		}
+		return std::make_unique<GameOfLife::GameOfLifeWorld>(settings.rows, settings.columns, population);
+	}
+	if (settings.name == "plant") {
+		PlantWorld::PlantWorld::UpdateMode mode;
+		if (settings.plantMode == "multipass") {
+			mode = PlantWorld::PlantWorld::UpdateMode::MultiPass;
+		} else if (settings.plantMode == "fused") {
+			mode = PlantWorld::PlantWorld::UpdateMode::Fused;
+		} else if (settings.plantMode == "parallel") {
+			mode = PlantWorld::PlantWorld::UpdateMode::Parallel;
+		} else {
+			return nullptr;
+		}
+		std::unique_ptr<PlantWorld::PlantWorld> world = defaultPopulation
+			? std::make_unique<PlantWorld::PlantWorld>(settings.rows, settings.columns)
+			: std::make_unique<PlantWorld::PlantWorld>(settings.rows, settings.columns, population);
+		world->setUpdateMode(mode);
+		return std::move(world);
+	}
+	return nullptr;
+}
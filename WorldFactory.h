@@ -0,0 +1,26 @@
+#ifndef WORLDFACTORY_H
+#define WORLDFACTORY_H
+
+#include "Simulation.h"
+
+#include <memory>
+#include <string>
+
+struct WorldSettings
+{
+	std::string name = "grid";
+	int rows = 128;
+	int columns = 128;
+	int population = -1; // initial organisms, negative for the world's default density
+	std::string plantMode = "fused"; // update of the plant world: multipass, fused or parallel
+};
+
+// Consumes the world option at argv[i] and its value, if it is one.
+bool parseWorldOption(int argc, char* argv[], int& i, WorldSettings& settings);
+
+const char* worldOptionsUsage();
+
+// Returns null for an unknown world name or plant mode, or invalid sizes.
+std::unique_ptr<Simulation> createWorld(const WorldSettings& settings);
+
+#endif // WORLDFACTORY_H
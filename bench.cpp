@@ -0,0 +1,552 @@
+#include "BenchmarkRunner.h"
+#include "BlockMap.h"
+#include "GameOfLife/GameOfLifeWorld.h"
+#include "Grid.h"
+#include "GridWorld/GridWorld.h"
+#include "ModuloIntDistribution.h"
+#include "PlantWorld/PlantWorld.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+// of the whole process, counted by the replaced operator new and delete below
+std::atomic<std::uint64_t> allocationCount(0);
+std::atomic<std::int64_t> allocatedBytes(0);
+
+// NOTE: allocations keep their size in front of them, for counting the bytes
+// they give back
+const std::size_t ALLOCATION_HEADER_SIZE = alignof(std::max_align_t);
+
+void* countedAllocate(std::size_t size) noexcept
+{
+	char* memory = static_cast<char*>(std::malloc(size + ALLOCATION_HEADER_SIZE));
+	if (!memory) {
+		return nullptr;
+	}
+	*reinterpret_cast<std::size_t*>(memory) = size;
+	allocationCount.fetch_add(1, std::memory_order_relaxed);
+	allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+	return memory + ALLOCATION_HEADER_SIZE;
+}
+
+void countedFree(void* pointer) noexcept
+{
+	if (!pointer) {
+		return;
+	}
+	char* memory = static_cast<char*>(pointer) - ALLOCATION_HEADER_SIZE;
+	allocatedBytes.fetch_sub(*reinterpret_cast<std::size_t*>(memory), std::memory_order_relaxed);
+	std::free(memory);
+}
+
+// NOTE: a power of two, operations pick their position with a mask
+const int POSITION_COUNT = 4096;
+
+const int BLOCK_SIZE = 128;
+
+// ticks before the timing, worlds start from a uniform random placement
+const int WARMUP_TICKS = 8;
+
+template <class T>
+std::vector<T> parseList(const char* text)
+{
+	std::vector<T> result;
+	std::stringstream stream(text);
+	std::string item;
+	while (std::getline(stream, item, ',')) {
+		result.push_back(T(std::atof(item.c_str())));
+	}
+	return result;
+}
+
+// keeps the compiler from dropping the computation of the value
+template <class T>
+void keep(const T& value)
+{
+	asm volatile("" : : "g"(&value) : "memory");
+}
+
+// at least radius cells away from the edges
+std::vector<Position> interiorPositions(int size, int radius, std::minstd_rand0& random)
+{
+	std::uniform_int_distribution<int> distribution(radius, size - 1 - radius);
+	std::vector<Position> positions;
+	for (int i = 0; i < POSITION_COUNT; ++i) {
+		int row = distribution(random);
+		positions.push_back(Position(row, distribution(random)));
+	}
+	return positions;
+}
+
+// closer than radius cells to an edge, the neighborhood wraps around
+std::vector<Position> edgePositions(int size, int radius, std::minstd_rand0& random)
+{
+	std::uniform_int_distribution<int> along(0, size - 1);
+	std::uniform_int_distribution<int> across(0, 2 * radius - 1);
+	std::vector<Position> positions;
+	for (int i = 0; i < POSITION_COUNT; ++i) {
+		int offset = across(random);
+		int edge = offset < radius ? offset : size - 2 * radius + offset;
+		int other = along(random);
+		positions.push_back(i % 2 == 0 ? Position(edge, other) : Position(other, edge));
+	}
+	return positions;
+}
+
+template <int Radius>
+void addMooreNeighborhoodCases(BenchmarkRunner& runner, Grid<GameOfLife::Cell>& grid, int size, std::minstd_rand0& random)
+{
+	const char* names[] = {"interior", "wraparound"};
+	for (const char* name : names) {
+		std::string caseName = "grid.mooreNeighborhoodAt<" + std::to_string(Radius) + ">." + name;
+		if (!runner.selected(caseName)) {
+			continue;
+		}
+		std::vector<Position> positions = std::strcmp(name, "interior") == 0
+			? interiorPositions(size, Radius, random) : edgePositions(size, Radius, random);
+		BenchmarkRunner::Case benchmark;
+		benchmark.name = caseName;
+		benchmark.size = size;
+		benchmark.cellsPerOperation = (2 * Radius + 1) * (2 * Radius + 1);
+		benchmark.run = [&grid, positions](std::uint64_t operationCount) {
+			for (std::uint64_t i = 0; i < operationCount; ++i) {
+				MooreNeighborhood<GameOfLife::Cell, Radius> neighborhood = grid.mooreNeighborhoodAt<Radius>(positions[i & (POSITION_COUNT - 1)]);
+				keep(neighborhood);
+			}
+		};
+		runner.run(benchmark);
+	}
+}
+
+void addGridCases(BenchmarkRunner& runner, int size)
+{
+	std::minstd_rand0 random(1);
+	Grid<GameOfLife::Cell> grid(size, size);
+	for (int row = 0; row < size; ++row) {
+		for (int col = 0; col < size; ++col) {
+			grid.at(row, col) = random() % 2;
+		}
+	}
+
+	if (runner.selected("grid.at")) {
+		std::vector<Position> positions = interiorPositions(size, 0, random);
+		BenchmarkRunner::Case benchmark;
+		benchmark.name = "grid.at";
+		benchmark.size = size;
+		benchmark.cellsPerOperation = 1;
+		benchmark.run = [&grid, positions](std::uint64_t operationCount) {
+			int sum = 0;
+			for (std::uint64_t i = 0; i < operationCount; ++i) {
+				sum += grid.at(positions[i & (POSITION_COUNT - 1)]);
+			}
+			keep(sum);
+		};
+		runner.run(benchmark);
+	}
+
+	addMooreNeighborhoodCases<1>(runner, grid, size, random);
+	addMooreNeighborhoodCases<2>(runner, grid, size, random);
+	addMooreNeighborhoodCases<3>(runner, grid, size, random);
+}
+
+void addBlockMapCases(BenchmarkRunner& runner, int size)
+{
+	std::minstd_rand0 random(1);
+	BlockMap<GameOfLife::Cell, BLOCK_SIZE, BLOCK_SIZE> blockMap(size, size);
+	for (int row = 0; row < size; ++row) {
+		for (int col = 0; col < size; ++col) {
+			blockMap.cell(row, col) = random() % 2;
+		}
+	}
+
+	if (runner.selected("blockMap.cell")) {
+		std::vector<Position> positions = interiorPositions(size, 0, random);
+		BenchmarkRunner::Case benchmark;
+		benchmark.name = "blockMap.cell";
+		benchmark.size = size;
+		benchmark.cellsPerOperation = 1;
+		benchmark.run = [&blockMap, positions](std::uint64_t operationCount) {
+			int sum = 0;
+			for (std::uint64_t i = 0; i < operationCount; ++i) {
+				sum += blockMap.cell(positions[i & (POSITION_COUNT - 1)]);
+			}
+			keep(sum);
+		};
+		runner.run(benchmark);
+	}
+
+	// NOTE: an operation goes over a whole block, in the order of the
+	// world updates
+	if (runner.selected("blockMap.block")) {
+		BenchmarkRunner::Case benchmark;
+		benchmark.name = "blockMap.block";
+		benchmark.size = size;
+		benchmark.cellsPerOperation = std::min(size, BLOCK_SIZE) * std::min(size, BLOCK_SIZE);
+		benchmark.run = [&blockMap](std::uint64_t operationCount) {
+			int blockCount = blockMap.rows() * blockMap.columns();
+			int sum = 0;
+			for (std::uint64_t i = 0; i < operationCount; ++i) {
+				int index = i % blockCount;
+				const Block<GameOfLife::Cell>& block = blockMap.block(index / blockMap.columns(), index % blockMap.columns());
+				for (int row = 0; row < block.rows(); ++row) {
+					for (int col = 0; col < block.columns(); ++col) {
+						sum += block.cell(row, col);
+					}
+				}
+			}
+			keep(sum);
+		};
+		runner.run(benchmark);
+	}
+}
+
+void addRandomCases(BenchmarkRunner& runner)
+{
+	// NOTE: the range of the position offsets of GridWorld, with the
+	// standard distribution as the reference
+	if (runner.selected("moduloIntDistribution")) {
+		BenchmarkRunner::Case benchmark;
+		benchmark.name = "moduloIntDistribution";
+		benchmark.run = [](std::uint64_t operationCount) {
+			std::minstd_rand0 random(1);
+			ModuloIntDistribution<> distribution(0, 7);
+			int sum = 0;
+			for (std::uint64_t i = 0; i < operationCount; ++i) {
+				sum += distribution(random);
+			}
+			keep(sum);
+		};
+		runner.run(benchmark);
+	}
+
+	if (runner.selected("uniformIntDistribution")) {
+		BenchmarkRunner::Case benchmark;
+		benchmark.name = "uniformIntDistribution";
+		benchmark.run = [](std::uint64_t operationCount) {
+			std::minstd_rand0 random(1);
+			std::uniform_int_distribution<int> distribution(0, 7);
+			int sum = 0;
+			for (std::uint64_t i = 0; i < operationCount; ++i) {
+				sum += distribution(random);
+			}
+			keep(sum);
+		};
+		runner.run(benchmark);
+	}
+}
+
+std::unique_ptr<Simulation> createBenchmarkWorld(const std::string& name, int size, int population)
+{
+	if (name == "gridWorld") {
+		std::unique_ptr<GridWorld> world = std::make_unique<GridWorld>(size, size, population);
+		world->setSeed(1);
+		return std::move(world);
+	}
+	if (name == "gameOfLifeWorld") {
+		return std::make_unique<GameOfLife::GameOfLifeWorld>(size, size, population);
+	}
+	std::unique_ptr<PlantWorld::PlantWorld> world = std::make_unique<PlantWorld::PlantWorld>(size, size, population);
+	world->setSeed(1);
+	if (name == "plantWorld.parallel") {
+		world->setUpdateMode(PlantWorld::PlantWorld::UpdateMode::Parallel);
+	}
+	return std::move(world);
+}
+
+// NOTE: the population of GridWorld is its plants, the animals come on top.
+// PlantWorld runs its serial fused update and its parallel block update, the
+// threads are those of OpenMP. Skipped cases are only listed.
+void addWorldCases(BenchmarkRunner& runner, int size, const std::vector<double>& occupancies, bool skipped)
+{
+	const char* names[] = {"gridWorld", "gameOfLifeWorld", "plantWorld", "plantWorld.parallel"};
+	for (const char* name : names) {
+		std::string caseName = std::string(name) + ".update";
+		if (!runner.selected(caseName)) {
+			continue;
+		}
+		for (double occupancy : occupancies) {
+			BenchmarkRunner::Case benchmark;
+			benchmark.name = caseName;
+			benchmark.size = size;
+			benchmark.occupancy = occupancy;
+			if (skipped) {
+				runner.skip(benchmark);
+				continue;
+			}
+
+			std::shared_ptr<Simulation> world = createBenchmarkWorld(name, size, int(occupancy * size * size));
+			if (!world->initialize()) {
+				std::cerr << caseName << " " << size << "x" << size << " failed to initialize" << std::endl;
+				continue;
+			}
+			for (int i = 0; i < WARMUP_TICKS; ++i) {
+				world->update();
+			}
+
+			benchmark.cellsPerOperation = double(world->cellCount());
+			benchmark.run = [world](std::uint64_t operationCount) {
+				for (std::uint64_t i = 0; i < operationCount; ++i) {
+					world->update();
+				}
+			};
+			benchmark.organisms = [world]() {
+				return double(world->organismCount());
+			};
+			runner.run(benchmark);
+		}
+	}
+}
+
+// The world after the warmup hashed with inline cells, every layout has to
+// come to the same world.
+std::uint64_t referenceDigest(int size, int population)
+{
+	BasicGridWorld<InlineCell> world(size, size, population);
+	world.setSeed(1);
+	world.initialize();
+	for (int i = 0; i < WARMUP_TICKS; ++i) {
+		world.update();
+	}
+	return world.digest();
+}
+
+// NOTE: the allocations counted include those of the world besides the cells,
+// which are the same for every layout
+template <class CellType>
+void addCellLayoutCase(BenchmarkRunner& runner, const std::string& layout, int size, double occupancy, int tickCount,
+	const std::function<std::uint64_t()>& digest, bool skipped)
+{
+	std::string caseName = "cellLayout." + layout + ".update";
+	if (!runner.selected(caseName)) {
+		return;
+	}
+
+	BenchmarkRunner::Case benchmark;
+	benchmark.name = caseName;
+	benchmark.size = size;
+	benchmark.occupancy = occupancy;
+	if (skipped) {
+		runner.skip(benchmark);
+		return;
+	}
+
+	struct Counts
+	{
+		std::uint64_t ticks;
+		std::uint64_t allocations;
+	};
+	std::shared_ptr<Counts> counts = std::make_shared<Counts>(Counts{0, 0});
+
+	std::int64_t bytesBefore = allocatedBytes.load();
+	std::shared_ptr<BasicGridWorld<CellType>> world = std::make_shared<BasicGridWorld<CellType>>(size, size, int(occupancy * size * size));
+	world->setSeed(1);
+	if (!world->initialize()) {
+		std::cerr << caseName << " " << size << "x" << size << " failed to initialize" << std::endl;
+		return;
+	}
+	for (int i = 0; i < WARMUP_TICKS; ++i) {
+		world->update();
+	}
+	std::int64_t heapBytes = allocatedBytes.load() - bytesBefore;
+	bool identical = world->digest() == digest();
+	if (!identical) {
+		std::cerr << caseName << " " << size << "x" << size << " differs from the world with inline cells" << std::endl;
+	}
+
+	benchmark.cellsPerOperation = double(world->cellCount());
+	benchmark.operationCount = tickCount;
+	benchmark.run = [world, counts](std::uint64_t operationCount) {
+		std::uint64_t allocationsBefore = allocationCount.load();
+		for (std::uint64_t i = 0; i < operationCount; ++i) {
+			world->update();
+		}
+		counts->allocations += allocationCount.load() - allocationsBefore;
+		counts->ticks += operationCount;
+	};
+	benchmark.organisms = [world]() {
+		return double(world->organismCount());
+	};
+	benchmark.values = [counts, heapBytes, identical]() {
+		return std::vector<std::pair<std::string, double>>{
+			{"cellBytes", double(sizeof(CellType))},
+			{"heapBytes", double(heapBytes)},
+			{"allocationsPerTick", double(counts->allocations) / counts->ticks},
+			{"identical", double(identical)},
+		};
+	};
+	runner.run(benchmark);
+}
+
+// The same seeded GridWorld with every layout of the cells, see Cell.h, over
+// the same ticks. Besides the time of a tick, the size of a cell, the heap
+// taken by the world after the warmup and the allocations of a tick.
+void addCellLayoutCases(BenchmarkRunner& runner, int size, const std::vector<double>& occupancies, int tickCount, bool skipped)
+{
+	for (double occupancy : occupancies) {
+		// NOTE: only worked out for the first layout that runs
+		bool digestKnown = false;
+		std::uint64_t digestValue = 0;
+		std::function<std::uint64_t()> digest = [&]() {
+			if (!digestKnown) {
+				digestValue = referenceDigest(size, int(occupancy * size * size));
+				digestKnown = true;
+			}
+			return digestValue;
+		};
+		addCellLayoutCase<InlineCell>(runner, "inline", size, occupancy, tickCount, digest, skipped);
+		addCellLayoutCase<HeapCell>(runner, "heap", size, occupancy, tickCount, digest, skipped);
+		addCellLayoutCase<RetainedCell>(runner, "retained", size, occupancy, tickCount, digest, skipped);
+		addCellLayoutCase<PimplInlineCell>(runner, "pimplInline", size, occupancy, tickCount, digest, skipped);
+		addCellLayoutCase<PimplHeapCell>(runner, "pimplHeap", size, occupancy, tickCount, digest, skipped);
+		addCellLayoutCase<PimplRetainedCell>(runner, "pimplRetained", size, occupancy, tickCount, digest, skipped);
+	}
+}
+
+} // namespace
+
+void* operator new(std::size_t size)
+{
+	void* pointer = countedAllocate(size);
+	if (!pointer) {
+		throw std::bad_alloc();
+	}
+	return pointer;
+}
+
+void* operator new[](std::size_t size)
+{
+	return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+	return countedAllocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+	return countedAllocate(size);
+}
+
+void operator delete(void* pointer) noexcept
+{
+	countedFree(pointer);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+	countedFree(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+	countedFree(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept
+{
+	countedFree(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept
+{
+	countedFree(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept
+{
+	countedFree(pointer);
+}
+
+// Times the grid primitives, the world updates and the layouts of the
+// GridWorld cells over world sizes and occupancies. Results go to stdout as
+// JSON without an output file, the progress to stderr.
+int main(int argc, char* argv[])
+{
+	std::vector<int> sizes = {128, 512, 2048, 4096, 8192};
+	std::vector<double> occupancies = {0.05, 0.15, 0.5};
+	// NOTE: a GridWorld takes about 100 bytes a cell, 8192x8192 about 7 GB.
+	// Worlds of more cells are listed as skipped, 0 runs all of them.
+	long long maxWorldCells = 0;
+	double minSeconds = 0.5;
+	int layoutTicks = 32;
+	std::string filter;
+	std::string outputPath;
+
+	for (int i = 1; i < argc; ++i) {
+		if ((i + 1) >= argc) {
+			std::cout << "usage: " << argv[0] << " [--sizes <n,...>] [--occupancies <x,...>] [--max-world-cells <n>]"
+				" [--min-time <seconds>] [--layout-ticks <n>] [--filter <text>] [--output <file>]" << std::endl;
+			return 1;
+		}
+		const char* option = argv[i++];
+		if (std::strcmp(option, "--sizes") == 0) {
+			sizes = parseList<int>(argv[i]);
+		} else if (std::strcmp(option, "--occupancies") == 0) {
+			occupancies = parseList<double>(argv[i]);
+		} else if (std::strcmp(option, "--max-world-cells") == 0) {
+			maxWorldCells = std::atoll(argv[i]);
+		} else if (std::strcmp(option, "--min-time") == 0) {
+			minSeconds = std::atof(argv[i]);
+		} else if (std::strcmp(option, "--layout-ticks") == 0) {
+			layoutTicks = std::atoi(argv[i]);
+		} else if (std::strcmp(option, "--filter") == 0) {
+			filter = argv[i];
+		} else if (std::strcmp(option, "--output") == 0) {
+			outputPath = argv[i];
+		} else {
+			std::cout << "unknown option: " << option << std::endl;
+			return 1;
+		}
+	}
+	for (int size : sizes) {
+		if (size < 8) {
+			std::cout << "sizes have to be at least 8" << std::endl;
+			return 1;
+		}
+	}
+	if (layoutTicks < 1) {
+		std::cout << "--layout-ticks has to be at least 1" << std::endl;
+		return 1;
+	}
+
+	BenchmarkRunner runner(minSeconds, filter);
+	addRandomCases(runner);
+	for (int size : sizes) {
+		addGridCases(runner, size);
+		addBlockMapCases(runner, size);
+		bool skipped = maxWorldCells > 0 && static_cast<long long>(size) * size > maxWorldCells;
+		if (skipped) {
+			std::cerr << "worlds of " << size << "x" << size << " skipped, more cells than --max-world-cells" << std::endl;
+		}
+		addWorldCases(runner, size, occupancies, skipped);
+		addCellLayoutCases(runner, size, occupancies, layoutTicks, skipped);
+	}
+
+	std::ofstream file;
+	if (!outputPath.empty()) {
+		file.open(outputPath);
+	}
+	std::ostream& out = outputPath.empty() ? std::cout : file;
+	runner.writeJson(out);
+	out.flush();
+	if (!out) {
+		std::cout << "Writing the results to " << outputPath << " failed" << std::endl;
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,166 @@
+#include "DomainRunner.h"
+#include "UnixSocketTransport.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+int runDomain(const DomainRunner::Settings& settings, int domain, int domainCount, const std::vector<int>& sockets, int resultPipe)
+{
+	UnixSocketTransport transport(domain, domainCount, sockets);
+	DomainRunner runner(settings, domain, domainCount, transport);
+	DomainRunner::Result result;
+	if (!runner.run(result)) {
+		std::cout << "domain " << domain << ": link broken" << std::endl;
+		return 1;
+	}
+	return ::write(resultPipe, &result, sizeof(result)) == sizeof(result) ? 0 : 1;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+	DomainRunner::Settings settings = {512, 512, -1, 5, 1, 1000};
+	int domainCount = 2;
+	bool verify = false;
+
+	for (int i = 1; i < argc; ++i) {
+		if (std::strcmp(argv[i], "--verify") == 0) {
+			verify = true;
+			continue;
+		}
+		if ((i + 1) >= argc) {
+			std::cout << "usage: " << argv[0] << " [--rows <n>] [--columns <n>] [--population <n>]"
+				" [--accidents <n>] [--seed <n>] [--ticks <n>] [--processes <n>] [--verify]" << std::endl;
+			return 1;
+		}
+		const char* option = argv[i++];
+		if (std::strcmp(option, "--rows") == 0) {
+			settings.rows = std::atoi(argv[i]);
+		} else if (std::strcmp(option, "--columns") == 0) {
+			settings.columns = std::atoi(argv[i]);
+		} else if (std::strcmp(option, "--population") == 0) {
+			settings.population = std::atoi(argv[i]);
+		} else if (std::strcmp(option, "--accidents") == 0) {
+			settings.accidentCount = std::atoi(argv[i]);
+		} else if (std::strcmp(option, "--seed") == 0) {
+			settings.seed = std::strtoul(argv[i], nullptr, 10);
+		} else if (std::strcmp(option, "--ticks") == 0) {
+			settings.tickCount = std::atoi(argv[i]);
+		} else if (std::strcmp(option, "--processes") == 0) {
+			domainCount = std::max(1, std::atoi(argv[i]));
+		} else {
+			std::cout << "unknown option: " << option << std::endl;
+			return 1;
+		}
+	}
+	if (settings.population < 0) {
+		settings.population = GridWorld::defaultPlantCount(settings.rows, settings.columns);
+	}
+	// NOTE: populations are placed on free cells
+	settings.population = int(std::min<std::int64_t>(settings.population, std::int64_t(settings.rows) * settings.columns));
+#if CELL_ORGANISM_USE_LINEAGE
+	std::cout << "domains do not track lineages, the run has no phylogeny" << std::endl;
+#endif
+
+	for (int domain = 0; domain < domainCount; ++domain) {
+		int firstBlockRow;
+		int blockRowCount;
+		if (!DomainRunner::partition(settings.rows, domainCount, domain, firstBlockRow, blockRowCount)) {
+			std::cout << "too few block rows for " << domainCount << " processes" << std::endl;
+			return 1;
+		}
+	}
+
+	std::vector<int> sockets;
+	if (!UnixSocketTransport::createLinks(domainCount, sockets)) {
+		std::cout << "could not create links" << std::endl;
+		return 1;
+	}
+
+	std::vector<int> resultPipes;
+	std::vector<pid_t> children;
+	for (int domain = 0; domain < domainCount; ++domain) {
+		int resultPipe[2];
+		if (::pipe(resultPipe) != 0) {
+			std::cout << "could not create pipe" << std::endl;
+			return 1;
+		}
+		pid_t pid = ::fork();
+		if (pid == 0) {
+			::close(resultPipe[0]);
+			std::exit(runDomain(settings, domain, domainCount, sockets, resultPipe[1]));
+		}
+		::close(resultPipe[1]);
+		resultPipes.push_back(resultPipe[0]);
+		children.push_back(pid);
+	}
+	for (int socket : sockets) {
+		::close(socket);
+	}
+
+	DomainRunner::Result total = {0, {0, 0, 0}, 0, 0, 0};
+	bool valid = true;
+	for (int domain = 0; domain < domainCount; ++domain) {
+		DomainRunner::Result result;
+		if (::read(resultPipes[domain], &result, sizeof(result)) != sizeof(result)) {
+			valid = false;
+		} else {
+			total.digest += result.digest;
+			total.population.plants += result.population.plants;
+			total.population.herbivores += result.population.herbivores;
+			total.population.carnivores += result.population.carnivores;
+			total.bytesSent += result.bytesSent;
+			total.communicationSeconds = std::max(total.communicationSeconds, result.communicationSeconds);
+			total.seconds = std::max(total.seconds, result.seconds);
+		}
+		::close(resultPipes[domain]);
+	}
+	for (pid_t pid : children) {
+		int status;
+		::waitpid(pid, &status, 0);
+		valid = valid && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+	}
+	if (!valid) {
+		std::cout << "a domain failed" << std::endl;
+		return 1;
+	}
+
+	int ticks = std::max(settings.tickCount, 1);
+	std::cout << "processes: " << domainCount << std::endl;
+	std::cout << "ticks: " << settings.tickCount << std::endl;
+	std::cout << "seconds: " << total.seconds << std::endl;
+	std::cout << "population: " << total.population.plants << " plants, "
+		<< total.population.herbivores << " herbivores, "
+		<< total.population.carnivores << " carnivores" << std::endl;
+	std::cout << "digest: " << std::hex << total.digest << std::dec << std::endl;
+	std::cout << "bytes/tick: " << double(total.bytesSent) / ticks << std::endl;
+	// NOTE: includes waiting for the token, the sweeps are sequential
+	std::cout << "communication ms/tick: " << total.communicationSeconds * 1000 / ticks << std::endl;
+
+	if (verify) {
+		GridWorld world(settings.rows, settings.columns, settings.population);
+		world.setSeed(settings.seed);
+		world.setAccidentCount(settings.accidentCount);
+		world.initialize();
+		for (int tick = 0; tick < settings.tickCount; ++tick) {
+			world.update();
+		}
+		bool same = world.digest() == total.digest;
+		std::cout << "single process digest: " << std::hex << world.digest() << std::dec
+			<< (same ? " (same)" : " (different)") << std::endl;
+		if (!same) {
+			return 1;
+		}
+	}
+
+	return 0;
+}
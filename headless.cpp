@@ -0,0 +1,90 @@
+#include "HeadlessApplication.h"
+#include "PhaseTrace.h"
+#include "WorldFactory.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+int main(int argc, char* argv[])
+{
+	WorldSettings settings;
+	settings.name = "plant";
+	int tickCount = 1000;
+	std::string tracePath;
+	std::string capturePath;
+	int capturePeriod = 100;
+	int captureScale = 1;
+	FrameWriter::Format captureFormat = FrameWriter::Format::Ppm;
+	std::string telemetryPath;
+	std::string phylogenyPath;
+	bool countPerf = false;
+
+	bool valid = true;
+	for (int i = 1; i < argc && valid; ++i) {
+		if (std::strcmp(argv[i], "--ticks") == 0 && (i + 1) < argc) {
+			tickCount = std::atoi(argv[++i]);
+		} else if (std::strcmp(argv[i], "--trace") == 0 && (i + 1) < argc) {
+			tracePath = argv[++i];
+		} else if (std::strcmp(argv[i], "--telemetry") == 0 && (i + 1) < argc) {
+			telemetryPath = argv[++i];
+		} else if (std::strcmp(argv[i], "--phylogeny") == 0 && (i + 1) < argc) {
+			phylogenyPath = argv[++i];
+		} else if (std::strcmp(argv[i], "--perf") == 0) {
+			countPerf = true;
+		} else if (std::strcmp(argv[i], "--capture") == 0 && (i + 1) < argc) {
+			capturePath = argv[++i];
+		} else if (std::strcmp(argv[i], "--capture-every") == 0 && (i + 1) < argc) {
+			capturePeriod = std::atoi(argv[++i]);
+		} else if (std::strcmp(argv[i], "--capture-scale") == 0 && (i + 1) < argc) {
+			captureScale = std::atoi(argv[++i]);
+		} else if (std::strcmp(argv[i], "--capture-raw") == 0) {
+			captureFormat = FrameWriter::Format::Raw;
+		} else {
+			valid = parseWorldOption(argc, argv, i, settings);
+		}
+	}
+
+	std::unique_ptr<Simulation> world = valid ? createWorld(settings) : nullptr;
+	if (!world || tickCount < 0 || capturePeriod <= 0 || captureScale <= 0) {
+		std::cout << "usage: " << argv[0] << " " << worldOptionsUsage() << " [--ticks <n>] [--trace <file>] [--telemetry <file>] [--phylogeny <file>] [--perf]"
+			<< " [--capture <path> [--capture-every <n>] [--capture-scale <n>] [--capture-raw]]" << std::endl;
+		return 1;
+	}
+
+	std::vector<std::string> telemetryColumns = world->telemetryColumns();
+	if (!telemetryPath.empty() && telemetryColumns.empty()) {
+		std::cout << "The " << settings.name << " world has no telemetry" << std::endl;
+		return 1;
+	}
+
+	if (!tracePath.empty()) {
+		PhaseTrace::startTrace();
+	}
+
+	HeadlessApplication app(std::move(world), tickCount);
+	if (!telemetryPath.empty()) {
+		app.setTelemetryWriter(std::make_unique<TelemetryWriter>(telemetryPath, std::move(telemetryColumns)));
+	}
+	if (!phylogenyPath.empty()) {
+		app.setPhylogenyPath(phylogenyPath);
+	}
+	if (countPerf) {
+		app.enablePerfCounters();
+	}
+	if (!capturePath.empty()) {
+		app.setFrameWriter(std::make_unique<FrameWriter>(capturePath, capturePeriod, captureScale, captureFormat));
+	}
+	if (!app.run()) {
+		return 1;
+	}
+
+	if (!tracePath.empty() && !PhaseTrace::writeTrace(tracePath)) {
+		std::cout << "Writing the trace to " << tracePath << " failed" << std::endl;
+		return 1;
+	}
+	return 0;
+}
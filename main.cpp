@@ -90,11 +90,52 @@ void update(const std::vector<AxisAlignedBoundingBox> &boxes, std::vector<Circle
 }*/
 
 #include "Application.h"
+#include "PhaseTrace.h"
+#include "WorldFactory.h"
 
-int main()
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+
+int main(int argc, char* argv[])
 {
-	Application app;
+	TickScheduler scheduler;
+	WorldSettings settings;
+	std::string tracePath;
+	bool valid = true;
+	for (int i = 1; i < argc && valid; ++i) {
+		if (std::strcmp(argv[i], "--max-throughput") == 0) {
+			scheduler.setMaxThroughput();
+		} else if (std::strcmp(argv[i], "--tps") == 0 && (i + 1) < argc && std::atof(argv[i + 1]) > 0) {
+			scheduler.setTickRate(std::atof(argv[++i]));
+		} else if (std::strcmp(argv[i], "--fps") == 0 && (i + 1) < argc && std::atof(argv[i + 1]) > 0) {
+			scheduler.setFrameRate(std::atof(argv[++i]));
+		} else if (std::strcmp(argv[i], "--trace") == 0 && (i + 1) < argc) {
+			tracePath = argv[++i];
+		} else {
+			valid = parseWorldOption(argc, argv, i, settings);
+		}
+	}
+
+	std::unique_ptr<Simulation> world = valid ? createWorld(settings) : nullptr;
+	if (!world) {
+		std::cout << "usage: " << argv[0] << " " << worldOptionsUsage() << " [--max-throughput | --tps <ticks/s> | --fps <frames/s>] [--trace <file>]" << std::endl;
+		return 1;
+	}
+
+	if (!tracePath.empty()) {
+		PhaseTrace::startTrace();
+	}
+
+	Application app(std::move(world), scheduler);
 	app.run();
 
+	if (!tracePath.empty() && !PhaseTrace::writeTrace(tracePath)) {
+		std::cout << "Writing the trace to " << tracePath << " failed" << std::endl;
+		return 1;
+	}
+
 	return 0;
 }
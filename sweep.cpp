@@ -0,0 +1,102 @@
+#include "SweepRunner.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+std::vector<int> parseList(const char* text)
+{
+	std::vector<int> result;
+	std::stringstream stream(text);
+	std::string item;
+	while (std::getline(stream, item, ',')) {
+		result.push_back(std::atoi(item.c_str()));
+	}
+	return result;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+	int rows = 128;
+	int columns = 128;
+	int tickCount = 1000;
+	int repeatCount = 1;
+	int threadCount = std::max(1u, std::thread::hardware_concurrency());
+	unsigned seed = 1;
+	std::vector<int> populations = {2500};
+	std::vector<int> accidentCounts = {5};
+	std::string outputPath = "sweep.csv";
+
+	for (int i = 1; i < argc; ++i) {
+		if ((i + 1) >= argc) {
+			std::cout << "usage: " << argv[0] << " [--rows <n>] [--columns <n>] [--ticks <n>]"
+				" [--populations <n,...>] [--accidents <n,...>] [--repeats <n>]"
+				" [--threads <n>] [--seed <n>] [--output <file>]" << std::endl;
+			return 1;
+		}
+		const char* option = argv[i++];
+		if (std::strcmp(option, "--rows") == 0) {
+			rows = std::atoi(argv[i]);
+		} else if (std::strcmp(option, "--columns") == 0) {
+			columns = std::atoi(argv[i]);
+		} else if (std::strcmp(option, "--ticks") == 0) {
+			tickCount = std::atoi(argv[i]);
+		} else if (std::strcmp(option, "--populations") == 0) {
+			populations = parseList(argv[i]);
+		} else if (std::strcmp(option, "--accidents") == 0) {
+			accidentCounts = parseList(argv[i]);
+		} else if (std::strcmp(option, "--repeats") == 0) {
+			repeatCount = std::atoi(argv[i]);
+		} else if (std::strcmp(option, "--threads") == 0) {
+			threadCount = std::max(1, std::atoi(argv[i]));
+		} else if (std::strcmp(option, "--seed") == 0) {
+			seed = std::strtoul(argv[i], nullptr, 10);
+		} else if (std::strcmp(option, "--output") == 0) {
+			outputPath = argv[i];
+		} else {
+			std::cout << "unknown option: " << option << std::endl;
+			return 1;
+		}
+	}
+
+	std::vector<SweepRunner::Run> runs;
+	for (int population : populations) {
+		for (int accidentCount : accidentCounts) {
+			for (int i = 0; i < repeatCount; ++i) {
+				// NOTE: populations are placed on free cells
+				runs.push_back({int(std::min<std::int64_t>(population, std::int64_t(rows) * columns)), accidentCount, seed + unsigned(runs.size())});
+			}
+		}
+	}
+
+	SweepRunner runner(rows, columns, tickCount, threadCount);
+	auto start = std::chrono::steady_clock::now();
+	std::vector<SweepRunner::Result> results = runner.run(runs);
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+	std::ofstream output(outputPath);
+	runner.writeSummary(output, results);
+
+	double seconds = elapsed.count();
+	std::cout << "runs: " << runs.size() << std::endl;
+	std::cout << "threads: " << threadCount << std::endl;
+	std::cout << "seconds: " << seconds << std::endl;
+	if (seconds > 0) {
+		std::cout << "ticks/s: " << double(runs.size()) * tickCount / seconds << std::endl;
+	}
+	std::cout << "summary: " << outputPath << std::endl;
+
+	return 0;
+}
@@ -0,0 +1,104 @@
+#include "TelemetryWriter.h"
+
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+template <class T>
+bool read(std::istream& in, T& value)
+{
+	return bool(in.read(reinterpret_cast<char*>(&value), sizeof(value)));
+}
+
+bool readHeader(std::istream& in, std::vector<std::string>& columns)
+{
+	std::uint64_t magic;
+	std::uint32_t version;
+	std::uint32_t columnCount;
+	if (!read(in, magic) || magic != TelemetryWriter::MAGIC || !read(in, version) || version != TelemetryWriter::VERSION || !read(in, columnCount)) {
+		return false;
+	}
+	for (std::uint32_t c = 0; c < columnCount; ++c) {
+		std::uint16_t length;
+		if (!read(in, length)) {
+			return false;
+		}
+		std::string column(length, '\0');
+		if (!in.read(&column[0], length)) {
+			return false;
+		}
+		columns.push_back(column);
+	}
+	return true;
+}
+
+// NOTE: rows of a chunk are consecutive ticks, ticks dropped by the writer
+// are missing between chunks
+bool writeChunk(std::istream& in, std::size_t columnCount, std::ostream& out)
+{
+	std::uint64_t firstTick;
+	std::uint32_t rowCount;
+	if (!read(in, firstTick) || !read(in, rowCount)) {
+		return false;
+	}
+	std::vector<std::int32_t> values(columnCount * rowCount);
+	if (!in.read(reinterpret_cast<char*>(values.data()), values.size() * sizeof(std::int32_t))) {
+		return false;
+	}
+	for (std::uint32_t r = 0; r < rowCount; ++r) {
+		out << (firstTick + r);
+		for (std::size_t c = 0; c < columnCount; ++c) {
+			out << ',' << values[c * rowCount + r];
+		}
+		out << '\n';
+	}
+	return true;
+}
+
+} // namespace
+
+// Converts a telemetry file of evolution-headless to CSV, one row per tick,
+// to stdout without a CSV file. Errors go to stderr.
+int main(int argc, char* argv[])
+{
+	if (argc != 2 && argc != 3) {
+		std::cout << "usage: " << argv[0] << " <telemetry file> [<csv file>]" << std::endl;
+		return 1;
+	}
+
+	std::ifstream in(argv[1], std::ios::binary);
+	std::vector<std::string> columns;
+	if (!readHeader(in, columns)) {
+		std::cerr << argv[1] << " is not a telemetry file" << std::endl;
+		return 1;
+	}
+
+	std::ofstream file;
+	if (argc == 3) {
+		file.open(argv[2]);
+	}
+	std::ostream& out = argc == 3 ? file : std::cout;
+
+	out << "tick";
+	for (const std::string& column : columns) {
+		out << ',' << column;
+	}
+	out << '\n';
+	while (in.peek() != std::ifstream::traits_type::eof()) {
+		if (!writeChunk(in, columns.size(), out)) {
+			std::cerr << argv[1] << " is truncated" << std::endl;
+			return 1;
+		}
+	}
+
+	out.flush();
+	if (!out) {
+		std::cerr << "Writing " << (argc == 3 ? argv[2] : "the CSV") << " failed" << std::endl;
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,192 @@
+#include "GridWorld/GridWorld.h"
+#include "PlantWorld/PlantWorld.h"
+
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+
+// the default population of large worlds does not overflow
+bool checkGridWorldDefaultPopulation()
+{
+	const int sizes[] = {1024, 4096, 8192, 46341};
+	for (int size : sizes) {
+		std::int64_t expected = std::int64_t(2500) * size * size / (128 * 128);
+		if (GridWorld::defaultPlantCount(size, size) != expected) {
+			std::cout << "default plants of " << size << "x" << size << ": " << GridWorld::defaultPlantCount(size, size)
+				<< ", expected " << expected << std::endl;
+			return false;
+		}
+	}
+
+	GridWorld world(1024, 1024);
+	world.setSeed(1);
+	if (!world.initialize()) {
+		std::cout << "a default 1024x1024 world failed to initialize" << std::endl;
+		return false;
+	}
+	GridWorld::Population population = world.population();
+	if (population.plants <= 0 || population.herbivores <= 0 || population.carnivores <= 0) {
+		std::cout << "a default 1024x1024 world has " << population.plants << " plants, " << population.herbivores
+			<< " herbivores and " << population.carnivores << " carnivores" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+void addQuantiles(std::map<std::string, std::int32_t>& values, const std::string& name, const Histogram& histogram)
+{
+	const double fractions[] = {0.1, 0.5, 0.9};
+	const char* const suffixes[] = {".p10", ".p50", ".p90"};
+	int quantiles[3];
+	histogram.quantiles(fractions, quantiles, 3);
+	for (int i = 0; i < 3; ++i) {
+		values[name + suffixes[i]] = quantiles[i];
+	}
+}
+
+void addQuantiles(std::map<std::string, std::int32_t>& values, const std::string& species, const GridWorldStatistics::OrganismHistograms& histograms)
+{
+	addQuantiles(values, species + ".reproductionEnergy", histograms.reproductionEnergies);
+	addQuantiles(values, species + ".offspringEnergy", histograms.offspringEnergies);
+	addQuantiles(values, species + ".geneDecrementFactor", histograms.geneDecrementFactors);
+	addQuantiles(values, species + ".geneStabilizeFactor", histograms.geneStabilizeFactors);
+	addQuantiles(values, species + ".geneIncrementFactor", histograms.geneIncrementFactors);
+}
+
+// The gene quantiles of the telemetry of every tick are those of all the
+// organisms alive, whether or not the world is analyzed.
+bool checkGridWorldTelemetryQuantiles()
+{
+	const int SIZE = 256;
+	GridWorld world(SIZE, SIZE);
+	world.setSeed(1);
+	world.initialize();
+	std::vector<std::string> columns = world.telemetryColumns();
+	std::vector<std::int32_t> values(columns.size());
+	std::vector<Cell> cells(SIZE);
+	for (int tick = 0; tick < 8; ++tick) {
+		world.update();
+		world.telemetry(values.data());
+
+		GridWorldStatistics::OrganismHistograms plants;
+		GridWorldStatistics::HerbivoreHistograms herbivores;
+		GridWorldStatistics::OrganismHistograms carnivores;
+		for (int row = 0; row < SIZE; ++row) {
+			world.copyRow(row, cells.data());
+			for (const Cell& cell : cells) {
+				if (cell.hasPlant()) {
+					plants.add(*cell.plant());
+				}
+				if (cell.hasHerbivore()) {
+					herbivores.add(*cell.herbivore());
+				}
+				if (cell.hasCarnivore()) {
+					carnivores.add(*cell.carnivore());
+				}
+			}
+		}
+		std::map<std::string, std::int32_t> expected;
+		addQuantiles(expected, "plant", plants);
+		addQuantiles(expected, "herbivore", herbivores);
+		addQuantiles(expected, "herbivore.feastSize", herbivores.feastSizes);
+		addQuantiles(expected, "carnivore", carnivores);
+
+		int compared = 0;
+		for (std::size_t i = 0; i < columns.size(); ++i) {
+			auto it = expected.find(columns[i]);
+			if (it == expected.end()) {
+				continue;
+			}
+			compared += 1;
+			if (values[i] != it->second) {
+				std::cout << "tick " << tick << " " << columns[i] << ": " << values[i] << ", expected " << it->second << std::endl;
+				return false;
+			}
+		}
+		if (compared != int(expected.size())) {
+			std::cout << "tick " << tick << ": " << compared << " of " << expected.size() << " quantile columns found" << std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+// The parallel block update of PlantWorld comes to the same plants as the
+// serial updates, tick by tick. Sizes cover a single block, whole blocks and
+// partial edge blocks.
+bool checkPlantWorldUpdateModes()
+{
+	typedef PlantWorld::PlantWorld::UpdateMode UpdateMode;
+	const int sizes[][2] = {{64, 64}, {256, 192}, {200, 150}};
+	const int TICKS = 32;
+	for (const auto& size : sizes) {
+		PlantWorld::PlantWorld multiPass(size[0], size[1]);
+		PlantWorld::PlantWorld fused(size[0], size[1]);
+		PlantWorld::PlantWorld parallel(size[0], size[1]);
+		multiPass.setUpdateMode(UpdateMode::MultiPass);
+		fused.setUpdateMode(UpdateMode::Fused);
+		parallel.setUpdateMode(UpdateMode::Parallel);
+		PlantWorld::PlantWorld* worlds[] = {&multiPass, &fused, &parallel};
+		for (PlantWorld::PlantWorld* world : worlds) {
+			world->setSeed(1);
+			world->initialize();
+		}
+		for (int tick = 0; tick <= TICKS; ++tick) {
+			if (tick > 0) {
+				for (PlantWorld::PlantWorld* world : worlds) {
+					world->update();
+				}
+			}
+			int plants = fused.organismCount();
+			if (plants <= 0 || plants > fused.cellCount()) {
+				std::cout << size[0] << "x" << size[1] << " tick " << tick << ": " << plants << " plants" << std::endl;
+				return false;
+			}
+			if (parallel.organismCount() != plants || multiPass.organismCount() != plants
+				|| parallel.digest() != fused.digest() || multiPass.digest() != fused.digest()) {
+				std::cout << size[0] << "x" << size[1] << " tick " << tick << ": plants multipass " << multiPass.organismCount()
+					<< ", fused " << plants << ", parallel " << parallel.organismCount() << ", or their digests differ" << std::endl;
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+struct Check
+{
+	const char* name;
+	bool (*run)();
+};
+
+const Check checks[] = {
+	{"gridWorld.defaultPopulation", checkGridWorldDefaultPopulation},
+	{"gridWorld.telemetryQuantiles", checkGridWorldTelemetryQuantiles},
+	{"plantWorld.updateModes", checkPlantWorldUpdateModes},
+};
+
+} // namespace
+
+// Runs the checks named on the command line, or all of them. Every failed
+// check prints what it found.
+int main(int argc, char* argv[])
+{
+	int failedCount = 0;
+	for (const Check& check : checks) {
+		bool selected = argc < 2;
+		for (int i = 1; i < argc; ++i) {
+			selected = selected || std::strcmp(argv[i], check.name) == 0;
+		}
+		if (!selected) {
+			continue;
+		}
+		bool passed = check.run();
+		std::cout << check.name << (passed ? " passed" : " FAILED") << std::endl;
+		failedCount += passed ? 0 : 1;
+	}
+	return failedCount == 0 ? 0 : 1;
+}